@@ -0,0 +1,95 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file aggregate-check.hpp
+ * @brief Debug check of logged sums against a full scan of the network.
+ *
+ * When aggregators are updated incrementally (values pushed on every storage write), the logged
+ * sums can be verified by a plotter-like checker, which scans every node at each log row and
+ * compares the results.
+ */
+
+#ifndef CASE_STUDY_AGGREGATE_CHECK_H_
+#define CASE_STUDY_AGGREGATE_CHECK_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+#include "lib/fcpp.hpp"
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for the debug check of logged aggregates.
+namespace aggregate_check {
+
+/**
+ * @brief Plotter-like checker of the logged `aggregator::sum` of the given storage tags.
+ *
+ * @param Ts The storage tags whose logged sums are checked.
+ */
+template <typename... Ts>
+class sums {
+  public:
+    //! @brief The full-scan results.
+    using values_type = std::array<double, sizeof...(Ts)>;
+
+    sums() = default;
+    sums(sums const&) = delete;
+    sums& operator=(sums const&) = delete;
+
+    //! @brief Reports the mismatches found (if any).
+    ~sums() {
+        if (m_mismatches > 0)
+            std::cerr << "aggregate check: " << m_mismatches << " mismatching sums in " << m_rows << " log rows" << std::endl;
+    }
+
+    //! @brief Sets the network to be scanned (with node identifiers from zero to its size).
+    template <typename N>
+    void watch(N& net) {
+        m_scan = [&net](){
+            values_type s{};
+            for (device_t uid = 0; uid < net.node_size(); ++uid) {
+                size_t k = 0;
+                ((s[k++] += static_cast<double>(net.node_at(uid).storage(Ts{}))), ...);
+            }
+            return s;
+        };
+    }
+
+    //! @brief Checks a logged row against a full scan of the network.
+    template <typename R>
+    sums& operator<<(R const& row) {
+        if (not m_scan) return *this;
+        values_type s = m_scan();
+        values_type logged = {static_cast<double>(common::get<aggregator::sum<Ts>>(row))...};
+        for (size_t k = 0; k < sizeof...(Ts); ++k)
+            if (std::abs(s[k] - logged[k]) > 1e-6 * std::max(1.0, std::abs(s[k]))) ++m_mismatches;
+        ++m_rows;
+        return *this;
+    }
+
+    //! @brief Number of mismatching sums found.
+    size_t mismatches() const {
+        return m_mismatches;
+    }
+
+  private:
+    //! @brief Computes the sums through a full scan.
+    std::function<values_type()> m_scan;
+    //! @brief Number of rows checked.
+    size_t m_rows = 0;
+    //! @brief Number of mismatching sums found.
+    size_t m_mismatches = 0;
+};
+
+} // namespace aggregate_check
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_AGGREGATE_CHECK_H_
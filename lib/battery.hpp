@@ -0,0 +1,100 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file battery.hpp
+ * @brief Battery models of the case study, with the radio profile of every battery level.
+ *
+ * A battery model schedules the round of the next transition of a node, and decides the level
+ * reached at that round. Nodes only update their radio profile when their level changes.
+ * Another model can be plugged in by providing the same interface (`rate`, `next_transition`
+ * and `transition`).
+ */
+
+#ifndef CASE_STUDY_BATTERY_H_
+#define CASE_STUDY_BATTERY_H_
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+
+#include "lib/fcpp.hpp"
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for battery models.
+namespace battery {
+
+//! @brief The highest battery level (levels range from zero).
+constexpr int max_level = 2;
+
+//! @brief Radio profile of a node.
+struct profile {
+    //! @brief The sleep ratio (less is better).
+    real_t sleep_ratio;
+    //! @brief The send power ratio (greater is better).
+    real_t send_power_ratio;
+    //! @brief The receive power ratio (greater is better).
+    real_t recv_power_ratio;
+    //! @brief The color of the node.
+    color node_color;
+};
+
+//! @brief Radio profiles of the LOW, MEDIUM and HIGH battery levels.
+inline std::array<profile, max_level + 1> const& profiles() {
+    static std::array<profile, max_level + 1> p = {{
+        {0.10, 0.25, 0.75, color(RED)},
+        {0.00, 0.75, 0.99, color(ORANGE)},
+        {0.00, 0.90, 1.00, color(GREEN)}
+    }};
+    return p;
+}
+
+//! @brief Radio profile of the source (which never sleeps and has perfect power ratios).
+inline profile const& source_profile() {
+    static profile p = {0.0, 1.0, 1.0, color(BLACK)};
+    return p;
+}
+
+/**
+ * @brief Geometric battery model, with three levels.
+ *
+ * Equivalent to drawing in every round an increase with probability `up`, and otherwise a decrease
+ * with probability `down`: the rounds between two draws that succeed are geometrically distributed,
+ * and a successful draw is an increase with probability `up / rate()`. Increases on the highest
+ * level and decreases on the lowest leave the level unchanged.
+ */
+struct geometric {
+    //! @brief Probability of a level increase in a round.
+    real_t up;
+    //! @brief Probability of a level decrease in a round without increase.
+    real_t down;
+
+    //! @brief Probability of a transition in a round.
+    real_t rate() const {
+        return up + (1 - up) * down;
+    }
+
+    //! @brief Round of the next transition after a given round, given a uniform draw in [0,1).
+    int next_transition(int round, real_t u) const {
+        real_t q = rate();
+        if (q <= 0) return INT_MAX;
+        if (q >= 1) return round + 1;
+        real_t gap = std::max<real_t>(std::ceil(std::log1p(-u) / std::log1p(-q)), 1);
+        return gap < INT_MAX - round ? round + (int)gap : INT_MAX;
+    }
+
+    //! @brief Level after a transition from a given level, given a uniform draw in [0,1).
+    int transition(int level, real_t u) const {
+        return std::clamp(u * rate() < up ? level + 1 : level - 1, 0, max_level);
+    }
+};
+
+} // namespace battery
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_BATTERY_H_
@@ -0,0 +1,118 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file benchmark.hpp
+ * @brief Helpers shared by the benchmark runners (argument parsing, process isolation, resource usage).
+ */
+
+#ifndef CASE_STUDY_BENCHMARK_H_
+#define CASE_STUDY_BENCHMARK_H_
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for benchmarking utilities.
+namespace bench {
+
+//! @brief Parses a comma-separated list of numbers.
+template <typename T = double>
+std::vector<T> parse_list(std::string const& s) {
+    std::vector<T> v;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (not item.empty()) v.push_back(T(std::stod(item)));
+    return v;
+}
+
+//! @brief Returns the value following `--name` in the command line arguments, or a default.
+inline std::string get_arg(int argc, char** argv, std::string const& name, std::string const& def) {
+    for (int a = 1; a + 1 < argc; ++a)
+        if (argv[a] == "--" + name) return argv[a + 1];
+    return def;
+}
+
+//! @brief A stream discarding everything written to it.
+inline std::ostream& null_stream() {
+    static std::ostream s(nullptr);
+    return s;
+}
+
+//! @brief Peak resident set size of the current process (in KiB, zero if not available).
+inline long peak_rss_kb() {
+#ifndef _WIN32
+    struct rusage r;
+    getrusage(RUSAGE_SELF, &r);
+#ifdef __APPLE__
+    return r.ru_maxrss / 1024;
+#else
+    return r.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Runs a function in a separate process and waits for its completion.
+ *
+ * Isolating every benchmark point in its own process keeps peak memory measurements independent.
+ * Where processes cannot be forked, the function is run in the current process.
+ *
+ * @return Whether the function completed successfully.
+ */
+template <typename F>
+bool run_isolated(F&& f) {
+#ifndef _WIN32
+    std::cout.flush();
+    std::cerr.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        // the child never returns into the caller, not even through an exception
+        int code = 0;
+        try {
+            f();
+        } catch (std::exception const& e) {
+            std::cerr << "error: " << e.what() << std::endl;
+            code = 1;
+        } catch (...) {
+            code = 1;
+        }
+        std::cout.flush();
+        std::cerr.flush();
+        _exit(code);
+    }
+    int status = 0;
+    if (pid < 0 or waitpid(pid, &status, 0) < 0) return false;
+    return WIFEXITED(status) and WEXITSTATUS(status) == 0;
+#else
+    try {
+        f();
+    } catch (std::exception const& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+#endif
+}
+
+} // namespace bench
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_BENCHMARK_H_
@@ -19,18 +19,55 @@
 #define INCREASE_BATTERY_PROB       0.01
 #define DECREASE_BATTERY_PROB       0.01
 
+//! @brief Whether node rounds are executed in parallel (0 = serial, 1 = parallel with the same results).
+#ifndef AP_PARALLEL
+#define AP_PARALLEL                 0
+#endif
+
+//! @brief Whether aggregators are updated on every round (1) or by scanning the network at every log (0).
+#ifndef AP_VALUE_PUSH
+#define AP_VALUE_PUSH               1
+#endif
+
+//! @brief Whether logged sums are checked against a full scan of the network in batches (debug only).
+#ifndef AP_CHECK_AGGREGATORS
+#define AP_CHECK_AGGREGATORS        0
+#endif
+
+//! @brief Whether runs terminate as soon as the source counters converge (0 = run until end, 1 = stop at convergence).
+#ifndef AP_EARLY_STOP
+#define AP_EARLY_STOP               0
+#endif
+
+#if AP_TRACE && AP_PARALLEL
+#error "connectivity traces are recorded by the thread running the simulation: record them with AP_PARALLEL=0"
+#endif
+
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
 
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "lib/fcpp.hpp"
+#include "lib/aggregate-check.hpp"
+#include "lib/battery.hpp"
+#include "lib/columnar.hpp"
+#include "lib/compact.hpp"
+#include "lib/node-random.hpp"
+#include "lib/stream-stats.hpp"
+#include "lib/profiler.hpp"
+#include "lib/retention.hpp"
+#include "lib/tie-break.hpp"
+#include "lib/trace.hpp"
 
 /**
  * @brief Namespace containing all the objects in the FCPP library.
@@ -57,7 +94,7 @@ namespace tags {
     struct node_parent {};
     //! @brief The rating of parent of the current node.
     struct node_rating_parent {};
-    //! @brief A source of the network.
+    //! @brief A source (gateway) of the network.
     struct node_source {};
     //! @brief The battery level of the current node.
     struct node_battery_level {};
@@ -79,6 +116,51 @@ namespace tags {
 
     //! @brief Number of working nodes: HIGH+MEDIUM profiles
     struct working_node {};
+
+    //! @brief Number of rounds performed by the current node.
+    struct node_round_count {};
+    //! @brief Seed of the random stream of the current node (drawn at creation).
+    struct node_random_seed {};
+    //! @brief Round of the next battery transition of the current node.
+    struct node_battery_transition {};
+    //! @brief Transition probability per round for which node_battery_transition was drawn.
+    struct node_battery_rate {};
+    //! @brief Number of neighbour messages used by the current node, fresh or retained (summed over all rounds).
+    struct node_neighbour_count {};
+    //! @brief Number of neighbour messages retained by the current node in the last round.
+    struct node_retained_messages {};
+    //! @brief Retention store of the neighbour messages held by a node with bounded retention.
+    struct node_retention {};
+    //! @brief Number of messages evicted by node_retention (over all rounds).
+    struct node_retention_evictions {};
+    //! @brief Bytes of node_retention in the last round (slots, index and payload of the messages held).
+    struct node_retention_bytes {};
+    //! @brief Time since which the source counters stay within tolerance (sources only).
+    struct convergence_time {};
+    //! @brief Source counters at convergence_time (sources only).
+    struct convergence_reference {};
+
+    //! @brief Bytes exported by a function during the last round.
+    template <typename>
+    struct export_bytes {};
+
+    //! @brief Profiling tag for abf_distance.
+    struct abf_distance_fn {};
+    //! @brief Profiling tag for uni_connection.
+    struct uni_connection_fn {};
+    //! @brief Profiling tag for bi_connection.
+    struct bi_connection_fn {};
+    //! @brief Profiling tag for mixed_connection.
+    struct mixed_connection_fn {};
+    //! @brief Profiling tag for sp_collection.
+    struct sp_collection_fn {};
+    //! @brief Profiling tag for the (fused) ssp_collection.
+    struct ssp_collection_fn {};
+
+    //! @brief Net initialisation tag for the number of nodes (scaling runs only).
+    struct scenario_node_num {};
+    //! @brief Net initialisation tag for the side of the deployment area (scaling runs only).
+    struct scenario_area_side {};
 }
 
 namespace configurations {
@@ -109,6 +191,31 @@ namespace configurations {
 
     //! @brief End of simulated time.
     constexpr size_t end = 250;
+
+    //! @brief Maximum change of a source counter still considered stable.
+    constexpr real_t convergence_tolerance = 0.5;
+    //! @brief Time for which source counters have to be stable to be considered converged.
+    constexpr real_t convergence_window = 20;
+
+    //! @brief Parameters of the program that can be changed between runs (or after forking a running simulation).
+    struct parameters_t {
+        //! @brief Factor by which the rating of a kept parent decays in ssp_collection.
+        real_t stale_factor = 0.7;
+        //! @brief Probability of a battery level increase in a round.
+        real_t increase_battery_prob = INCREASE_BATTERY_PROB;
+        //! @brief Probability of a battery level decrease in a round.
+        real_t decrease_battery_prob = DECREASE_BATTERY_PROB;
+        //! @brief Number of gateways (the nodes with identifiers below it).
+        device_t gateway_num = 1;
+        //! @brief Maximum number of neighbour messages held by the retention store of a node (unbounded by default).
+        size_t retention_capacity = std::numeric_limits<size_t>::max();
+    };
+
+    //! @brief The parameters used by every simulation in the process (not to be changed while simulations are running).
+    inline parameters_t& parameters() {
+        static parameters_t p;
+        return p;
+    }
 }
 
 // [AGGREGATE PROGRAM]
@@ -127,13 +234,15 @@ FUN field<real_t> bi_connection(ARGS) { CODE
     });
 }
 
-//! @brief Compute rating using old and nbr communications with each neighbour.
+//! @brief Compute rating using old and nbr communications with each neighbour (storing the bytes it exports, which are not the ones it returns).
 FUN field<real_t> mixed_connection(ARGS) { CODE
     return oldnbr(CALL, field<real_t>{0.0}, [&](field<real_t> o, field<real_t> n){
-        return make_tuple(
-            n,
-            mux(o == 0, n/2, o) + mod_other(CALL, 1, 0)
-        );
+        // single pass over the neighbours for mux(o == 0, n/2, o) + mod_other(CALL, 1, 0)
+        field<real_t> evolved = map_hood([](real_t o, real_t n, real_t m){
+            return (o == 0 ? n/2 : o) + m;
+        }, o, n, mod_other(CALL, 1.0, 0.0));
+        node.storage(fcpp::coordination::tags::export_bytes<fcpp::coordination::tags::mixed_connection_fn>{}) = compact::wire_size(evolved);
+        return make_tuple(std::move(n), std::move(evolved));
     });
 }
 
@@ -155,7 +264,14 @@ T ssp_collection(ARGS, P const& distance, T const& value, U const& null, G&& acc
 
         R rating_evolved = rating*stale_factor;
 
-        if (best_neigh_computed != parent && best_neigh_rating_computed < rating_evolved) {
+        if (distance == P(0)) {
+            // sources are roots, so that no source is collected into another
+            return make_tuple(
+                folded_value,
+                (R)0,
+                node.uid
+            );
+        } else if (best_neigh_computed != parent && best_neigh_rating_computed < rating_evolved) {
             return make_tuple(
                 folded_value,
                 rating_evolved,
@@ -181,6 +297,94 @@ T ssp_collection(ARGS, P const& distance, T const& value, U const& null, G&& acc
 //! @brief Export types used by the ssp_collection function.
 GEN_EXPORT(P, T, R) ssp_collection_t = export_list<tuple<T, R, device_t>, P>;
 
+//! @brief Implementation details.
+namespace details {
+    //! @brief Joins an array of fields into a field of arrays.
+    template <typename R, size_t K, size_t... Is>
+    field<std::array<R, K>> join_fields(std::array<field<R>, K> const& f, std::index_sequence<Is...>) {
+        return map_hood([](auto const&... r){
+            return std::array<R, K>{r...};
+        }, f[Is]...);
+    }
+}
+
+//! @brief Payload of the multi-rating ssp_collection function (values, ratings and parents, in wire representation).
+template <typename T, typename R, size_t K>
+using ssp_multi_payload_t = tuple<std::array<compact::wire_t<T>, K>, std::array<compact::wire_t<R>, K>, std::array<compact::wire_t<device_t>, K>>;
+
+//! @brief Data collection with the stabilized single-path strategy, for K rating fields within a single exchange.
+template <typename node_t, typename P, typename T, typename U, typename G, typename R, size_t K>
+std::array<T, K> ssp_collection(ARGS, P const& distance, T const& value, U const& null, G&& accumulate, std::array<field<R>, K> const& field_ratings, R const& stale_factor) { CODE
+    using payload_t = ssp_multi_payload_t<T, R, K>;
+    using candidate_t = std::array<tuple<P, R, device_t>, K>;
+
+    payload_t init;
+    get<0>(init).fill(T(null));
+    get<1>(init).fill((R)0);
+    get<2>(init).fill(node.uid);
+    payload_t result = nbr(CALL, init, [&](field<payload_t> x){
+
+        // single min pass over the neighbours, for every rating at once
+        field<candidate_t> candidates = map_hood([](P const& d, std::array<R, K> const& r, device_t i){
+            candidate_t c;
+            for (size_t k = 0; k < K; ++k) c[k] = make_tuple(d, -r[k], i);
+            return c;
+        }, nbr(CALL, distance), details::join_fields(field_ratings, std::make_index_sequence<K>{}), nbr_uid(CALL));
+        candidate_t best_neigh_field = fold_hood(CALL, [](candidate_t const& a, candidate_t b){
+            for (size_t k = 0; k < K; ++k) if (a[k] < b[k]) b[k] = a[k];
+            return b;
+        }, candidates);
+
+        // single fold pass over the children, for every rating at once
+        field<std::array<T, K>> children = map_hood([&](payload_t const& t){
+            std::array<T, K> c;
+            for (size_t k = 0; k < K; ++k) c[k] = (device_t)get<2>(t)[k] == node.uid ? (T)get<0>(t)[k] : (T)null;
+            return c;
+        }, x);
+        std::array<T, K> own;
+        own.fill(value);
+        std::array<T, K> folded_value = fold_hood(CALL, [&](std::array<T, K> const& a, std::array<T, K> b){
+            for (size_t k = 0; k < K; ++k) b[k] = accumulate(a[k], b[k]);
+            return b;
+        }, children, own);
+
+        payload_t const& self_x = self(CALL, x);
+        payload_t r;
+        for (size_t k = 0; k < K; ++k) {
+            get<0>(r)[k] = folded_value[k];
+            R best_neigh_rating_computed = -get<1>(best_neigh_field[k]);
+            device_t best_neigh_computed = get<2>(best_neigh_field[k]);
+            R rating_evolved = (R)get<1>(self_x)[k]*stale_factor;
+            device_t parent = get<2>(self_x)[k];
+
+            if (distance == P(0)) {
+                // sources are roots, so that no source is collected into another
+                get<1>(r)[k] = (R)0;
+                get<2>(r)[k] = node.uid;
+            } else if (best_neigh_computed != parent && best_neigh_rating_computed < rating_evolved) {
+                get<1>(r)[k] = rating_evolved;
+                get<2>(r)[k] = parent;
+            } else {
+                get<1>(r)[k] = best_neigh_rating_computed;
+                get<2>(r)[k] = best_neigh_computed;
+            }
+        }
+        return r;
+    });
+
+    // the last rating field determines the stored parent, as for consecutive ssp_collection calls
+    node.storage(fcpp::coordination::tags::node_parent{}) = get<2>(result)[K-1];
+    node.storage(fcpp::coordination::tags::node_rating_parent{}) = get<1>(result)[K-1];
+    node.storage(fcpp::coordination::tags::export_bytes<fcpp::coordination::tags::ssp_collection_fn>{}) = compact::wire_size(result) + compact::wire_size(distance);
+
+    std::array<T, K> computed_value;
+    for (size_t k = 0; k < K; ++k) computed_value[k] = get<0>(result)[k];
+    return computed_value;
+}
+//! @brief Export types used by the multi-rating ssp_collection function.
+template <typename P, typename T, typename R, size_t K>
+using ssp_multi_collection_t = export_list<ssp_multi_payload_t<T, R, K>, P>;
+
 //! @brief Main function.
 MAIN() {
     // import tag names in the local scope.
@@ -188,122 +392,150 @@ MAIN() {
     using namespace fcpp::component::tags;
 
     // usage of node storage
+    AP_PROFILE_RESET(abf_distance_fn, uni_connection_fn, bi_connection_fn, mixed_connection_fn, sp_collection_fn, ssp_collection_fn);
     node.storage(node_size{}) = 3;
-    node.storage(node_color{}) = color(BLACK);
+    node.storage(node_round_count{}) += 1;
+    node.storage(node_retained_messages{}) = count_hood(CALL) - 1;
+    node.storage(node_neighbour_count{}) += node.storage(node_retained_messages{});
     node.storage(node_shape{}) = shape::sphere;
 
-    bool source = node.uid == 0; // source is node 0
+    // sources are the gateways, nodes 0 to gateway_num-1: every node is collected towards the nearest one
+    bool source = node.uid < configurations::parameters().gateway_num;
     node.storage(node_source{}) = source;
 
-    // probability to increase battery
-    real_t rnd_increase = node.next_real(1);
-    if (rnd_increase <= INCREASE_BATTERY_PROB) {
-        int new_battery_level;
-        switch(node.storage(node_battery_level{}))
-        {
-            case MEDIUM_BATTERY:
-                new_battery_level = HIGH_BATTERY;
-                break;
-            case LOW_BATTERY:
-                new_battery_level = MEDIUM_BATTERY;
-                break;
-            default:
-                new_battery_level = node.storage(node_battery_level{});
-                break;
-        }
-        node.storage(node_battery_level{}) = new_battery_level;
-    } else {
-        // probability to decrease battery
-        real_t rnd_decrease = node.next_real(1);
-        if (rnd_decrease <= DECREASE_BATTERY_PROB) {
-            int new_battery_level;
-            switch(node.storage(node_battery_level{}))
-            {
-                case HIGH_BATTERY:
-                    new_battery_level = MEDIUM_BATTERY;
-                    break;
-                case MEDIUM_BATTERY:
-                    new_battery_level = LOW_BATTERY;
-                    break;
-                default:
-                    new_battery_level = node.storage(node_battery_level{});
-                    break;
-            }
-            node.storage(node_battery_level{}) = new_battery_level;
-        }
-    }
-
-    real_t sleep_ratio_v; // less is better
-    real_t send_power_ratio_v; // greater is better
-    real_t recv_power_ratio_v; // greater is better
-    fcpp:color new_color;
+    // random draws from the node stream, independent of the execution order of rounds
+    uint64_t stream_key = node_random::key(node.storage(node_random_seed{}));
+    uint64_t round = node.storage(node_round_count{});
 
+    // battery transitions, on the rounds scheduled by the battery model
+    int& battery_level = node.storage(node_battery_level{});
+    bool battery_changed = round == 1;
     if (source) {
-        new_color = color(BLACK);
-        node.storage(node_battery_level{}) = HIGH_BATTERY;
-
-        sleep_ratio_v = 0.0; // the source never ends itself
-        send_power_ratio_v = 1.0; // the source has perfect "send" power ratio
-        recv_power_ratio_v = 1.0; // the source has perfect "recv" power ratio
+        battery_level = HIGH_BATTERY;
     } else {
-        switch(node.storage(node_battery_level{}))
-        {
-            case HIGH_BATTERY:
-                sleep_ratio_v = 0.0;
-                send_power_ratio_v = 0.90;
-                recv_power_ratio_v = 1.00;
-                new_color = color(GREEN);
-                break;
-            case MEDIUM_BATTERY:
-                sleep_ratio_v = 0.0;
-                send_power_ratio_v = 0.75;
-                recv_power_ratio_v = 0.99;
-                new_color = color(ORANGE);
-                break;
-            case LOW_BATTERY:
-                sleep_ratio_v = 0.10;
-                send_power_ratio_v = 0.25;
-                recv_power_ratio_v = 0.75;
-                new_color = color(RED);
-                break;
-            default:
-                break;
+        battery::geometric model{configurations::parameters().increase_battery_prob, configurations::parameters().decrease_battery_prob};
+        int& next_transition = node.storage(node_battery_transition{});
+        real_t& rate = node.storage(node_battery_rate{});
+        if (rate != model.rate()) {
+            // first round or changed parameters: the model is memoryless, so the next transition can be redrawn
+            rate = model.rate();
+            next_transition = model.next_transition(round - 1, node_random::uniform(stream_key, round, 2));
+        }
+        if ((int)round == next_transition) {
+            int new_battery_level = model.transition(battery_level, node_random::uniform(stream_key, round, 0));
+            battery_changed |= new_battery_level != battery_level;
+            battery_level = new_battery_level;
+            next_transition = model.next_transition(round, node_random::uniform(stream_key, round, 1));
         }
     }
-    fcpp::common::get<sleep_ratio>(node.connector_data()) = sleep_ratio_v; 
-    fcpp::common::get<send_power_ratio>(node.connector_data()) = send_power_ratio_v; 
-    fcpp::common::get<recv_power_ratio>(node.connector_data()) = recv_power_ratio_v; 
-    node.storage(node_color{}) = new_color;
+
+    // the radio profile only changes with the battery level
+    if (battery_changed) {
+        battery::profile const& p = source ? battery::source_profile() : battery::profiles()[battery_level];
+        fcpp::common::get<sleep_ratio>(node.connector_data()) = p.sleep_ratio;
+        fcpp::common::get<send_power_ratio>(node.connector_data()) = p.send_power_ratio;
+        fcpp::common::get<recv_power_ratio>(node.connector_data()) = p.recv_power_ratio;
+        node.storage(node_color{}) = p.node_color;
+    }
 
     auto adder = [](real_t x, real_t y) {
         return x+y;
     };
 
-    real_t distance = coordination::abf_distance(CALL, source);
+    real_t distance = AP_PROFILED(abf_distance_fn, coordination::abf_distance(CALL, source));
 
-    field<real_t> uniConnRating         = uni_connection(CALL);
-    field<real_t> biConnRating          = bi_connection(CALL); 
-    field<real_t> mixedConnRating       = mixed_connection(CALL); 
+    // ratings are built in place (uniconn, biconn, mixed), and never copied
+    std::array<field<real_t>, 3> ratings = {
+        AP_PROFILED(uni_connection_fn, uni_connection(CALL)),
+        AP_PROFILED(bi_connection_fn, bi_connection(CALL)),
+        AP_PROFILED(mixed_connection_fn, mixed_connection(CALL))
+    };
 
-    real_t value_sp_classic         = coordination::sp_collection(CALL, distance, 1.0, 0, adder);
+    real_t value_sp_classic         = AP_PROFILED(sp_collection_fn, coordination::sp_collection(CALL, distance, 1.0, 0, adder));
+    // sp_collection breaks ties among sources by identifier, collecting a source into a neighbour source with lower identifier
+    bool classic_root = source;
+    if (configurations::parameters().gateway_num > 1)
+        classic_root &= not any_hood(CALL, map_hood([&](bool s, device_t i){
+            return s and i < node.uid;
+        }, nbr(CALL, source), nbr_uid(CALL)));
 
-    const real_t stale_factor = 0.7;
-    real_t value_ssp_mod_uniConn     = coordination::ssp_collection(CALL, distance, 1.0, 0, adder, uniConnRating, stale_factor);
-    real_t value_ssp_mod_biConn      = coordination::ssp_collection(CALL, distance, 1.0, 0, adder, biConnRating, stale_factor);
-    real_t value_ssp_mod_mixed       = coordination::ssp_collection(CALL, distance, 1.0, 0, adder, mixedConnRating, stale_factor);
+    const real_t stale_factor = configurations::parameters().stale_factor;
+    std::array<real_t, 3> value_ssp  = AP_PROFILED(ssp_collection_fn, coordination::ssp_collection(CALL, distance, 1.0, 0, adder, ratings, stale_factor));
+    real_t value_ssp_mod_uniConn     = value_ssp[0];
+    real_t value_ssp_mod_biConn      = value_ssp[1];
+    real_t value_ssp_mod_mixed       = value_ssp[2];
 
     node.storage(node_alert_counter<tags::classic>{})   = value_sp_classic;
     node.storage(node_alert_counter<tags::uniconn>{})   = value_ssp_mod_uniConn;
     node.storage(node_alert_counter<tags::biconn>{})    = value_ssp_mod_biConn;
     node.storage(node_alert_counter<tags::mixed>{})     = value_ssp_mod_mixed;
-    node.storage(node_rating{})                         = mixedConnRating;
 
-    // update counter of the source
+    // bytes exported in this round, by function (mixed_connection and ssp_collection account for themselves)
+    node.storage(export_bytes<abf_distance_fn>{})       = compact::wire_size(distance);
+    node.storage(export_bytes<uni_connection_fn>{})     = compact::wire_size(ratings[0]);
+    node.storage(export_bytes<bi_connection_fn>{})      = compact::wire_size(ratings[1]);
+    node.storage(node_rating{})                         = std::move(ratings[2]);
+    node.storage(export_bytes<sp_collection_fn>{})      = compact::wire_size(value_sp_classic) + compact::wire_size(distance) + compact::wire_size(node.storage(node_parent{}));
+
+    // bounded retention: the messages that the node would hold with retention_capacity slots, offered as they arrive
+    // (FCPP still keeps every message for the retain window, so the computation above is not affected)
+    retention::store<retention::oldest_first>& retained = node.storage(node_retention{});
+    if (round == 1) retained = retention::store<retention::oldest_first>(configurations::parameters().retention_capacity);
+    field<device_t> neighbours = nbr_uid(CALL);
+    std::vector<device_t> const& heard = fcpp::details::get_ids(neighbours);
+    retained.expire([&](device_t uid){
+        return std::binary_search(heard.begin(), heard.end(), uid);
+    });
+    // the payload of a neighbour message is estimated by the bytes exported by the node itself
+    size_t payload = node.storage(export_bytes<abf_distance_fn>{}) + node.storage(export_bytes<uni_connection_fn>{}) + node.storage(export_bytes<bi_connection_fn>{})
+                   + node.storage(export_bytes<mixed_connection_fn>{}) + node.storage(export_bytes<sp_collection_fn>{}) + node.storage(export_bytes<ssp_collection_fn>{});
+    times_t since_last = node.current_time() - node.previous_time();
+    fold_hood(CALL, [&](tuple<device_t, times_t> const& h, int n){
+        // messages received since the previous round are new, the others were already offered
+        if (get<0>(h) != node.uid and get<1>(h) < since_last) retained.offer(get<0>(h), (uint32_t)round, payload, [](device_t){
+            return 0;
+        });
+        return n;
+    }, make_tuple(neighbours, node.nbr_lag()), 0);
+    node.storage(node_retention_evictions{}) = retained.evictions();
+    node.storage(node_retention_bytes{}) = retained.bytes();
+
+#if AP_TRACE
+    // record the round in the connectivity trace of the current run (if any)
+    field<int> nbr_round = nbr(CALL, node.storage(node_round_count{}));
+    if (trace::recorder* recorder = trace::recorder::active()) {
+        trace::round_record r{
+            node.current_time(), node.uid, (uint32_t)round,
+            (float)fcpp::common::get<sleep_ratio>(node.connector_data()),
+            (float)fcpp::common::get<send_power_ratio>(node.connector_data()),
+            (float)fcpp::common::get<recv_power_ratio>(node.connector_data()),
+            {(float)value_sp_classic, (float)value_ssp_mod_uniConn, (float)value_ssp_mod_biConn, (float)value_ssp_mod_mixed},
+            {}
+        };
+        r.messages = fold_hood(CALL, [](tuple<device_t, int, real_t> const& h, std::vector<trace::heard> v){
+            v.push_back({get<0>(h), (uint32_t)get<1>(h), (float)get<2>(h)});
+            return std::move(v);
+        }, make_tuple(nbr_uid(CALL), nbr_round, node.nbr_dist()), std::vector<trace::heard>{});
+        recorder->record(std::move(r));
+    }
+#endif
+
+    // update the partial counters of the source (summed over sources by the aggregators)
     if (node.storage(fcpp::coordination::tags::node_source{})) {
-        node.storage(fcpp::coordination::tags::source_alert_counter<tags::classic>{})   = value_sp_classic;
+        node.storage(fcpp::coordination::tags::source_alert_counter<tags::classic>{})   = classic_root ? value_sp_classic : 0;
         node.storage(fcpp::coordination::tags::source_alert_counter<tags::uniconn>{})   = value_ssp_mod_uniConn;
         node.storage(fcpp::coordination::tags::source_alert_counter<tags::biconn>{})    = value_ssp_mod_biConn;
         node.storage(fcpp::coordination::tags::source_alert_counter<tags::mixed>{})     = value_ssp_mod_mixed;
+
+        // track since when the counters are stable
+        std::array<real_t, 4> counters = {classic_root ? value_sp_classic : 0, value_ssp_mod_uniConn, value_ssp_mod_biConn, value_ssp_mod_mixed};
+        std::array<real_t, 4>& reference = node.storage(convergence_reference{});
+        for (size_t k = 0; k < counters.size(); ++k)
+            if (std::abs(counters[k] - reference[k]) > configurations::convergence_tolerance) {
+                reference = counters;
+                node.storage(convergence_time{}) = node.current_time();
+                break;
+            }
     }
 
     // update counter of working nodes
@@ -313,8 +545,41 @@ MAIN() {
         node.storage(fcpp::coordination::tags::source_alert_counter<tags::working_node>{}) = 0;
     }
 }
+#if AP_TRACE
+//! @brief Export types used for trace recording (round numbers).
+FUN_EXPORT trace_t = export_list<int>;
+#else
+//! @brief Export types used for trace recording (none).
+FUN_EXPORT trace_t = export_list<>;
+#endif
+//! @brief Export types used for detecting neighbour sources.
+FUN_EXPORT gateway_t = export_list<bool>;
 //! @brief Export types used by the main function (update it when expanding the program).
-FUN_EXPORT main_t = export_list<any_connection_t, ssp_collection_t<real_t, real_t, real_t>, sp_collection_t<real_t, real_t>, abf_distance_t>;
+FUN_EXPORT main_t = export_list<any_connection_t, ssp_multi_collection_t<real_t, real_t, real_t, 3>, sp_collection_t<real_t, real_t>, abf_distance_t, gateway_t, trace_t>;
+
+/**
+ * @brief Runs a network up to its end, or with `AP_EARLY_STOP` until its source counters converge.
+ *
+ * The network total is stable once the partial counters of every source are. The convergence times
+ * of the sources are read between events of the network, when no round is running (not even with
+ * `AP_PARALLEL`), and the network terminates after the event in which the latest of them is
+ * `convergence_window` old.
+ */
+template <typename N>
+void run_network(N& network) {
+#if AP_EARLY_STOP
+    while (network.next() < TIME_MAX) {
+        times_t t = network.next();
+        network.update();
+        times_t stable_since = 0;
+        for (device_t g = 0; g < configurations::parameters().gateway_num and g < network.node_size(); ++g)
+            stable_since = std::max<times_t>(stable_since, network.node_at(g).storage(tags::convergence_time{}));
+        if (t - stable_since >= configurations::convergence_window) network.terminate();
+    }
+#else
+    network.run();
+#endif
+}
 
 } // namespace coordination
 
@@ -330,12 +595,12 @@ using namespace coordination::tags;
 //! @brief Import tags used by configurations.
 using namespace coordination::configurations;
 
-//! @brief Description of the round schedule.
-using round_s = sequence::periodic<
+//! @brief Description of the round schedule (with times distinct among nodes, so that rounds are ordered by time and uid).
+using round_s = tie_break::sequence<sequence::periodic<
     distribution::interval_n<times_t, 0, 1>,    // uniform time in the [0,1] interval for start
     distribution::weibull_n<times_t, 10, 1, 10>, // weibull-distributed time for interval (10/10=1 mean, 1/10=0.1 deviation)
     distribution::constant_n<times_t, coordination::configurations::end+5>
->;
+>>;
 //! @brief The sequence of network snapshots (one every simulated second).
 using log_s = sequence::periodic_n<1, 0, 1, coordination::configurations::end>;
 //! @brief The sequence of node generation events (node_num devices all generated at time 0).
@@ -348,6 +613,10 @@ using i = distribution::constant_i<R, T>;
 //! @brief Shorthand for a constant numeric distribution.
 template <intmax_t num, intmax_t den = 1>
 using n = distribution::constant_n<double, num, den>;
+//! @brief The sequence of node generation events for scaling runs (scenario_node_num devices all generated at time 0).
+using scenario_spawn_s = sequence::multiple<i<scenario_node_num, size_t>, distribution::constant_n<times_t, 0>>;
+//! @brief The distribution of initial node positions for scaling runs (random in a [scenario_area_side x scenario_area_side] square).
+using scenario_rectangle_d = distribution::rect<n<0>, n<0>, i<scenario_area_side>, i<scenario_area_side>>;
 
 //! @brief The contents of the node storage as tags and associated types.
 using store_t = tuple_store<
@@ -366,6 +635,37 @@ using store_t = tuple_store<
     node_source,                        bool,
     node_battery_level,                 int, // 0=LOW, 1=MEDIUM, 2=HIGH
     working_node,                       int, // 1=HIGH+MEDIUM, 0=LOW
+    node_round_count,                   int,
+    node_random_seed,                   real_t,
+    node_battery_transition,            int,
+    node_battery_rate,                  real_t,
+    node_neighbour_count,               real_t,
+    node_retained_messages,             real_t,
+    node_retention,                     retention::store<retention::oldest_first>,
+    node_retention_evictions,           real_t,
+    node_retention_bytes,               real_t,
+    convergence_time,                   real_t,
+    convergence_reference,              std::array<real_t, 4>,
+    export_bytes<abf_distance_fn>,      real_t,
+    export_bytes<uni_connection_fn>,    real_t,
+    export_bytes<bi_connection_fn>,     real_t,
+    export_bytes<mixed_connection_fn>,  real_t,
+    export_bytes<sp_collection_fn>,     real_t,
+    export_bytes<ssp_collection_fn>,    real_t,
+#if AP_PROFILE
+    profile_cycles<abf_distance_fn>,     real_t,
+    profile_cycles<uni_connection_fn>,   real_t,
+    profile_cycles<bi_connection_fn>,    real_t,
+    profile_cycles<mixed_connection_fn>, real_t,
+    profile_cycles<sp_collection_fn>,    real_t,
+    profile_cycles<ssp_collection_fn>,   real_t,
+    profile_calls<abf_distance_fn>,      real_t,
+    profile_calls<uni_connection_fn>,    real_t,
+    profile_calls<bi_connection_fn>,     real_t,
+    profile_calls<mixed_connection_fn>,  real_t,
+    profile_calls<sp_collection_fn>,     real_t,
+    profile_calls<ssp_collection_fn>,    real_t,
+#endif
 
     source_alert_counter<classic>,      real_t,
     source_alert_counter<uniconn>,      real_t,
@@ -389,7 +689,34 @@ using aggregator_t = aggregators<
     source_alert_counter<biconn>,       aggregator::sum<real_t>,
     source_alert_counter<mixed>,        aggregator::sum<real_t>,
 
-    source_alert_counter<working_node>, aggregator::sum<real_t>
+    source_alert_counter<working_node>, aggregator::sum<real_t>,
+
+    export_bytes<abf_distance_fn>,      aggregator::sum<real_t>,
+    export_bytes<uni_connection_fn>,    aggregator::sum<real_t>,
+    export_bytes<bi_connection_fn>,     aggregator::sum<real_t>,
+    export_bytes<mixed_connection_fn>,  aggregator::sum<real_t>,
+    export_bytes<sp_collection_fn>,     aggregator::sum<real_t>,
+    export_bytes<ssp_collection_fn>,    aggregator::sum<real_t>,
+    node_retained_messages,             aggregator::sum<real_t>,
+    node_retention_evictions,           aggregator::sum<real_t>,
+    node_retention_bytes,               aggregator::sum<real_t>,
+
+#if AP_PROFILE
+    profile_cycles<abf_distance_fn>,     aggregator::sum<real_t>,
+    profile_cycles<uni_connection_fn>,   aggregator::sum<real_t>,
+    profile_cycles<bi_connection_fn>,    aggregator::sum<real_t>,
+    profile_cycles<mixed_connection_fn>, aggregator::sum<real_t>,
+    profile_cycles<sp_collection_fn>,    aggregator::sum<real_t>,
+    profile_cycles<ssp_collection_fn>,   aggregator::sum<real_t>,
+    profile_calls<abf_distance_fn>,      aggregator::sum<real_t>,
+    profile_calls<uni_connection_fn>,    aggregator::sum<real_t>,
+    profile_calls<bi_connection_fn>,     aggregator::sum<real_t>,
+    profile_calls<mixed_connection_fn>,  aggregator::sum<real_t>,
+    profile_calls<sp_collection_fn>,     aggregator::sum<real_t>,
+    profile_calls<ssp_collection_fn>,    aggregator::sum<real_t>,
+#endif
+
+    convergence_time,                   aggregator::max<real_t>
 >;
 
 //! @brief Tag in the aggregation tuple for a source alert counter.
@@ -401,38 +728,52 @@ using lines_t = plot::join<plot::value<T<Ts>>...>;
 using avg_alert_per_node_t = plot::split<plot::time, lines_t<avg_alert_per_node, classic, uniconn, biconn, mixed>>;
 //! @brief Plot of the total collection result over time.
 using sum_source_alert_counter_t = plot::split<plot::time, lines_t<sum_source_alert_counter, classic, uniconn, biconn, mixed, working_node>>;
+//! @brief Tag in the aggregation tuple for the bytes exported by a function.
+template <typename F> using sum_export_bytes = aggregator::sum<export_bytes<F>>;
+//! @brief Plot of the bytes exported by every function over time (last round of every node).
+using export_bytes_t = plot::split<plot::time, lines_t<sum_export_bytes, abf_distance_fn, uni_connection_fn, bi_connection_fn, mixed_connection_fn, sp_collection_fn, ssp_collection_fn>>;
+//! @brief Plot of the neighbour messages retained over the network (last round of every node).
+using retained_messages_t = plot::split<plot::time, plot::value<aggregator::sum<node_retained_messages>>>;
+//! @brief Plot of the time since which source counters are stable.
+using convergence_time_t = plot::split<plot::time, plot::value<aggregator::max<convergence_time>>>;
+#if AP_PROFILE
+//! @brief Tag in the aggregation tuple for the cycles spent in a function.
+template <typename F> using sum_profile_cycles = aggregator::sum<profile_cycles<F>>;
+//! @brief Tag in the aggregation tuple for the calls to a function.
+template <typename F> using sum_profile_calls = aggregator::sum<profile_calls<F>>;
+//! @brief Plot of the cycles spent in every function over time (last round of every node).
+using profile_cycles_t = plot::split<plot::time, lines_t<sum_profile_cycles, abf_distance_fn, uni_connection_fn, bi_connection_fn, mixed_connection_fn, sp_collection_fn, ssp_collection_fn>>;
+//! @brief Plot of the calls to every function over time (last round of every node).
+using profile_calls_t = plot::split<plot::time, lines_t<sum_profile_calls, abf_distance_fn, uni_connection_fn, bi_connection_fn, mixed_connection_fn, sp_collection_fn, ssp_collection_fn>>;
 //! @brief Overall plot page.
-using plot_t = plot::join<sum_source_alert_counter_t, avg_alert_per_node_t>;
+using plot_t = plot::join<sum_source_alert_counter_t, profile_cycles_t, profile_calls_t, avg_alert_per_node_t, export_bytes_t, retained_messages_t, convergence_time_t>;
+#else
+//! @brief Overall plot page.
+using plot_t = plot::join<sum_source_alert_counter_t, avg_alert_per_node_t, export_bytes_t, retained_messages_t, convergence_time_t>;
+#endif
 
 //! @brief Connection predicate (supports power and sleep ratio, 50% loss at 70% of communication range)
 using connect_t = connect::radial<70, connect::powered<coordination::configurations::communication_range, 1, dim>>;
 
-//! @brief The general simulation options.
-DECLARE_OPTIONS(list,
-    parallel<false>,      // multithreading enabled on node rounds
+//! @brief The simulation options shared by every scenario.
+DECLARE_OPTIONS(common_list,
+    parallel<AP_PARALLEL>, // multithreading enabled on node rounds
+    value_push<AP_VALUE_PUSH>, // aggregators updated incrementally after every round
     synchronised<false>, // optimise for asynchronous networks
     program<coordination::main>,   // program to be run (refers to MAIN above)
     exports<coordination::main_t>, // export type list (types used in messages)
     retain<metric::retain<5,1>>,   // messages are kept for 5 seconds before expiring
     round_schedule<round_s>, // the sequence generator for round events on nodes
     log_schedule<log_s>,     // the sequence generator for log events on the network
-    spawn_schedule<spawn_s>, // the sequence generator of node creation events on the network
     store_t,       // the contents of the node storage
     aggregator_t,  // the tags and corresponding aggregators to be logged
-    log_functors<
-        avg_alert_per_node<classic>,        functor::div<aggregator::sum<node_alert_counter<classic>>, n<coordination::configurations::node_num>>,
-        avg_alert_per_node<uniconn>,        functor::div<aggregator::sum<node_alert_counter<uniconn>>, n<coordination::configurations::node_num>>,
-        avg_alert_per_node<biconn>,         functor::div<aggregator::sum<node_alert_counter<biconn>>, n<coordination::configurations::node_num>>,
-        avg_alert_per_node<mixed>,          functor::div<aggregator::sum<node_alert_counter<mixed>>, n<coordination::configurations::node_num>>
-    >,
     init<
-        x,                                  rectangle_d, // initialise position randomly in a rectangle for new nodes
         node_battery_level,                 distribution::interval_n<times_t, 0, 3>,    // greater is better
+        node_random_seed,                   distribution::interval_n<real_t, 0, 1>,     // seed of the node random stream
         send_power_ratio,                   distribution::interval_n<times_t, 1, 1>,    // greater is better
         recv_power_ratio,                   distribution::interval_n<times_t, 1, 1>,    // greater is better
         sleep_ratio,                        distribution::interval_n<times_t, 0, 1>     // less is better
     >,
-    plot_type<plot_t>,
     dimension<dim>, // dimensionality of the space
     connector<connect_t>,  // the connection predicate
     shape_tag<node_shape>, // the shape of a node is read from this tag in the store
@@ -440,6 +781,83 @@ DECLARE_OPTIONS(list,
     color_tag<node_color>  // the color of a node is read from this tag in the store
 );
 
+//! @brief The scenario options fixed at compile time by configurations.
+DECLARE_OPTIONS(fixed_scenario,
+    spawn_schedule<spawn_s>, // the sequence generator of node creation events on the network
+    log_functors<
+        avg_alert_per_node<classic>,        functor::div<aggregator::sum<node_alert_counter<classic>>, n<coordination::configurations::node_num>>,
+        avg_alert_per_node<uniconn>,        functor::div<aggregator::sum<node_alert_counter<uniconn>>, n<coordination::configurations::node_num>>,
+        avg_alert_per_node<biconn>,         functor::div<aggregator::sum<node_alert_counter<biconn>>, n<coordination::configurations::node_num>>,
+        avg_alert_per_node<mixed>,          functor::div<aggregator::sum<node_alert_counter<mixed>>, n<coordination::configurations::node_num>>
+    >,
+    init<
+        x,                                  rectangle_d // initialise position randomly in a rectangle for new nodes
+    >
+);
+
+/**
+ * @brief The scenario options given at runtime.
+ *
+ * Nets built with these options read the number of nodes and the area side from the
+ * `scenario_node_num` and `scenario_area_side` initialisation values, and the communication
+ * range from the `radius` initialisation value.
+ */
+DECLARE_OPTIONS(runtime_scenario,
+    spawn_schedule<scenario_spawn_s>, // the sequence generator of node creation events on the network
+    log_functors<
+        avg_alert_per_node<classic>,        functor::div<aggregator::sum<node_alert_counter<classic>>, i<scenario_node_num>>,
+        avg_alert_per_node<uniconn>,        functor::div<aggregator::sum<node_alert_counter<uniconn>>, i<scenario_node_num>>,
+        avg_alert_per_node<biconn>,         functor::div<aggregator::sum<node_alert_counter<biconn>>, i<scenario_node_num>>,
+        avg_alert_per_node<mixed>,          functor::div<aggregator::sum<node_alert_counter<mixed>>, i<scenario_node_num>>
+    >,
+    init<
+        x,                                  scenario_rectangle_d // initialise position randomly in a rectangle for new nodes
+    >
+);
+
+//! @brief The general simulation options.
+DECLARE_OPTIONS(list,
+    common_list,
+    fixed_scenario,
+    plot_type<plot_t>
+);
+
+//! @brief Cross-run statistics of the plotted values, with memory independent of the number of runs.
+using stats_t = stats::time_stats<
+    sum_source_alert_counter<classic>, sum_source_alert_counter<uniconn>, sum_source_alert_counter<biconn>, sum_source_alert_counter<mixed>, sum_source_alert_counter<working_node>,
+    avg_alert_per_node<classic>, avg_alert_per_node<uniconn>, avg_alert_per_node<biconn>, avg_alert_per_node<mixed>,
+    aggregator::max<convergence_time>
+>;
+
+#if AP_CHECK_AGGREGATORS
+//! @brief Debug check of the logged sums against a full scan of the network.
+using aggregate_check_t = aggregate_check::sums<
+    node_alert_counter<classic>, node_alert_counter<uniconn>, node_alert_counter<biconn>, node_alert_counter<mixed>,
+    source_alert_counter<classic>, source_alert_counter<uniconn>, source_alert_counter<biconn>, source_alert_counter<mixed>,
+    source_alert_counter<working_node>
+>;
+
+//! @brief The plotter type of batch runs (forwards rows to a plot_t, a stats_t and an aggregate_check_t, optionally streaming them to a columnar file).
+using batch_plot_t = columnar::run_sink<plot_t, stats_t, aggregate_check_t>;
+#else
+//! @brief The plotter type of batch runs (forwards rows to a plot_t and a stats_t, optionally streaming them to a columnar file).
+using batch_plot_t = columnar::run_sink<plot_t, stats_t>;
+#endif
+
+//! @brief The simulation options for batch runs.
+DECLARE_OPTIONS(batch_list,
+    common_list,
+    fixed_scenario,
+    plot_type<batch_plot_t>
+);
+
+//! @brief The simulation options with the scenario given at runtime.
+DECLARE_OPTIONS(scenario_list,
+    common_list,
+    runtime_scenario,
+    plot_type<plot_t>
+);
+
 } // namespace option
 
 } // namespace fcpp
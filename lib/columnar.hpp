@@ -0,0 +1,450 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file columnar.hpp
+ * @brief Binary streaming output of logged rows, with a memory-mapped reader and a text converter.
+ *
+ * A columnar file starts with a header (magic string, number of columns, column names, padding
+ * to 8 bytes), followed by blocks of rows. A block holds the run identifier and the number of rows,
+ * then every logged column (time first) as a contiguous array of doubles. Runs append a block every
+ * `block_rows` rows and when they complete, so the file can be shared by all the runs of a batch and
+ * the blocks of different runs may interleave. The comment lines that FCPP writes to the text output of
+ * a run (the header with the parameters and column names, and the footer) are kept in text blocks,
+ * with the highest bit of the number of rows set and the text length below it, so that `to_text`
+ * reproduces the text output of the run.
+ */
+
+#ifndef CASE_STUDY_COLUMNAR_H_
+#define CASE_STUDY_COLUMNAR_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "lib/fcpp.hpp"
+#include "lib/mapped-file.hpp"
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for the binary columnar output format.
+namespace columnar {
+
+//! @brief Magic string at the start of a columnar file.
+constexpr char magic[8] = {'A', 'P', 'C', 'O', 'L', 'v', '3', '\0'};
+
+//! @brief Flag marking text blocks in the number of rows.
+constexpr uint64_t text_flag = uint64_t(1) << 63;
+
+//! @brief Number of rows after which a run appends a block to the file.
+constexpr size_t block_rows = 64;
+
+//! @brief Appends rows to a columnar file, shared by concurrent runs.
+class writer {
+  public:
+    //! @brief Creates (or truncates) the file at the given path.
+    explicit writer(std::string const& path) : m_file(std::fopen(path.c_str(), "wb")) {
+        if (m_file == nullptr) throw std::runtime_error("cannot open " + path);
+    }
+
+    writer(writer const&) = delete;
+    writer& operator=(writer const&) = delete;
+
+    ~writer() {
+        std::fclose(m_file);
+    }
+
+    /**
+     * @brief Appends a block of rows of a run, writing the header first if needed.
+     *
+     * @param names The column names (run identifier excluded).
+     * @param run The run identifier.
+     * @param data The values of every column, each with the same number of rows.
+     */
+    void append(std::vector<std::string> const& names, double run, std::vector<std::vector<double>> const& data) {
+        std::lock_guard<std::mutex> l(m_mutex);
+        header(names);
+        if (m_columns != data.size() + 1) throw std::runtime_error("columnar rows with mismatching columns");
+        uint64_t rows = data.empty() ? 0 : data[0].size();
+        std::fwrite(&run, sizeof(double), 1, m_file);
+        std::fwrite(&rows, sizeof(uint64_t), 1, m_file);
+        for (std::vector<double> const& c : data) std::fwrite(c.data(), sizeof(double), rows, m_file);
+        std::fflush(m_file);
+    }
+
+    /**
+     * @brief Appends a block of text of a run (padded to 8 bytes), writing the header first if needed.
+     *
+     * @param names The column names (run identifier excluded).
+     * @param run The run identifier.
+     * @param text The text.
+     */
+    void append_text(std::vector<std::string> const& names, double run, std::string const& text) {
+        std::lock_guard<std::mutex> l(m_mutex);
+        header(names);
+        uint64_t length = text.size() | text_flag;
+        std::fwrite(&run, sizeof(double), 1, m_file);
+        std::fwrite(&length, sizeof(uint64_t), 1, m_file);
+        std::fwrite(text.data(), 1, text.size(), m_file);
+        char const padding[8] = {};
+        std::fwrite(padding, 1, (8 - text.size() % 8) % 8, m_file);
+        std::fflush(m_file);
+    }
+
+  private:
+    //! @brief Writes the header of the file if not written yet, and checks the column names otherwise.
+    void header(std::vector<std::string> const& names) {
+        if (m_columns == 0) {
+            m_columns = names.size() + 1;
+            std::vector<char> h(magic, magic + sizeof(magic));
+            put(h, uint64_t(m_columns));
+            put(h, std::string("run"));
+            for (std::string const& n : names) put(h, n);
+            h.resize((h.size() + 7) / 8 * 8, '\0');
+            std::fwrite(h.data(), 1, h.size(), m_file);
+        } else if (m_columns != names.size() + 1)
+            throw std::runtime_error("columnar rows with mismatching columns");
+    }
+
+    //! @brief Appends a number to a buffer.
+    static void put(std::vector<char>& h, uint64_t x) {
+        char const* p = reinterpret_cast<char const*>(&x);
+        h.insert(h.end(), p, p + sizeof(x));
+    }
+
+    //! @brief Appends a string to a buffer.
+    static void put(std::vector<char>& h, std::string const& s) {
+        put(h, uint64_t(s.size()));
+        h.insert(h.end(), s.begin(), s.end());
+    }
+
+    //! @brief The output file.
+    std::FILE* m_file;
+    //! @brief Serialises appends.
+    std::mutex m_mutex;
+    //! @brief Number of columns (zero before the header is written).
+    size_t m_columns = 0;
+};
+
+/**
+ * @brief Plotter-like sink collecting the rows of a single run.
+ *
+ * Rows are forwarded to optional plotters, and appended to an optional writer in blocks of
+ * `block_rows` rows, the last one when the sink is destroyed (at the end of the run). The stream
+ * returned by `output()` is meant as the text output of the run: it keeps the comment and empty lines
+ * written to it, appending them to the writer in the order they come with respect to rows, and drops
+ * the lines of rows (which the sink receives as values). The sink has to outlive the run.
+ *
+ * A run stopped early can be carried forward with `carry`, which repeats its last row at the later log
+ * times for the plotters (not for the writer, which keeps the rows actually logged).
+ *
+ * @param Ps The types of the plotters receiving the rows.
+ */
+template <typename... Ps>
+class run_sink {
+  public:
+    //! @brief Default constructor (discarding everything).
+    run_sink() : m_plotters(static_cast<Ps*>(nullptr)...) {}
+
+    //! @brief Constructor with a writer, a run identifier and the plotters (writer and plotters may be null).
+    run_sink(writer* out, double run, Ps*... plotters) : m_plotters(plotters...), m_out(out), m_run(run) {}
+
+    run_sink(run_sink const&) = delete;
+    run_sink& operator=(run_sink const&) = delete;
+
+    ~run_sink() {
+        m_comments.end_line();
+        flush();
+        flush_text();
+    }
+
+    //! @brief A stream keeping the comment lines written to it for the writer.
+    std::ostream* output() {
+        return &m_output;
+    }
+
+    //! @brief Processes a logged row.
+    template <typename... Ss, typename... Ts>
+    run_sink& operator<<(common::tagged_tuple<common::type_sequence<Ss...>, common::type_sequence<Ts...>> const& row) {
+        using row_type = common::tagged_tuple<common::type_sequence<Ss...>, common::type_sequence<Ts...>>;
+        plot(row);
+        if (m_last == nullptr) {
+            m_last = std::make_shared<row_type>(row);
+            m_carry = [](run_sink& sink, void const* last, times_t until, times_t period) {
+                row_type r = *static_cast<row_type const*>(last);
+                for (times_t t = common::get<plot::time>(r) + period; t <= until; t += period) {
+                    common::get<plot::time>(r) = t;
+                    sink.plot(r);
+                }
+            };
+        } else *static_cast<row_type*>(m_last.get()) = row;
+        if (m_out != nullptr) {
+            if (m_names.empty()) {
+                m_names = {common::type_name<Ss>()...};
+                m_data.resize(sizeof...(Ss));
+                for (std::vector<double>& c : m_data) c.reserve(block_rows);
+            }
+            flush_text();
+            size_t c = 0;
+            (m_data[c++].push_back(static_cast<double>(common::get<Ss>(row))), ...);
+            if (m_data[0].size() == block_rows) flush();
+        }
+        return *this;
+    }
+
+    //! @brief Repeats the last row for the plotters at every `period` after it, up to `until` (for runs stopped before `until`).
+    void carry(times_t until, times_t period) {
+        if (m_last != nullptr) m_carry(*this, m_last.get(), until, period);
+    }
+
+  private:
+    //! @brief Forwards a row to the plotters.
+    template <typename R>
+    void plot(R const& row) {
+        std::apply([&](auto*... p){
+            ((p != nullptr ? (void)(*p << row) : (void)0), ...);
+        }, m_plotters);
+    }
+
+    //! @brief Stream buffer passing the comment and empty lines to the sink, and dropping the others.
+    class comment_buffer : public std::streambuf {
+      public:
+        //! @brief Constructor given the sink.
+        explicit comment_buffer(run_sink& sink) : m_sink(sink) {}
+
+        //! @brief Passes the line being written to the sink, if any.
+        void end_line() {
+            if (m_kept and not m_line.empty()) m_sink.text(m_line);
+            m_line.clear();
+            m_start = true;
+        }
+
+      protected:
+        //! @brief Processes a character.
+        int_type overflow(int_type c) override {
+            if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+            char ch = traits_type::to_char_type(c);
+            if (m_start) m_kept = ch == '#' or ch == '\n';
+            m_start = false;
+            if (m_kept) m_line.push_back(ch);
+            if (ch == '\n') end_line();
+            return c;
+        }
+
+      private:
+        //! @brief The sink.
+        run_sink& m_sink;
+        //! @brief The line being written, if kept.
+        std::string m_line;
+        //! @brief Whether the next character starts a line.
+        bool m_start = true;
+        //! @brief Whether the line being written is kept.
+        bool m_kept = false;
+    };
+
+    //! @brief Receives lines of text, after the rows buffered so far.
+    void text(std::string const& line) {
+        if (m_out == nullptr) return;
+        flush();
+        m_text += line;
+    }
+
+    //! @brief Appends the buffered rows to the writer.
+    void flush() {
+        if (m_out == nullptr or m_data.empty() or m_data[0].empty()) return;
+        m_out->append(m_names, m_run, m_data);
+        for (std::vector<double>& c : m_data) c.clear();
+    }
+
+    //! @brief Appends the buffered text to the writer (text before the first row waits for the column names).
+    void flush_text() {
+        if (m_out == nullptr or m_names.empty() or m_text.empty()) return;
+        m_out->append_text(m_names, m_run, m_text);
+        m_text.clear();
+    }
+
+    //! @brief The plotters receiving the rows.
+    std::tuple<Ps*...> m_plotters;
+    //! @brief The writer receiving the rows.
+    writer* m_out = nullptr;
+    //! @brief The run identifier.
+    double m_run = 0;
+    //! @brief The column names.
+    std::vector<std::string> m_names;
+    //! @brief The buffered rows, by column.
+    std::vector<std::vector<double>> m_data;
+    //! @brief The buffered text.
+    std::string m_text;
+    //! @brief The last row (of the type logged by the run).
+    std::shared_ptr<void> m_last;
+    //! @brief Repeats the last row for the plotters.
+    void (*m_carry)(run_sink&, void const*, times_t, times_t) = nullptr;
+    //! @brief The buffer of the text output.
+    comment_buffer m_comments{*this};
+    //! @brief The text output.
+    std::ostream m_output{&m_comments};
+};
+
+/**
+ * @brief Read-only memory-mapped view of a columnar file.
+ *
+ * Opening the file scans the block headers once, indexing the blocks of every run.
+ */
+class reader {
+  public:
+    //! @brief A block of rows or text of a run.
+    struct block {
+        //! @brief The run identifier.
+        double run;
+        //! @brief Number of rows (zero for text blocks).
+        size_t rows;
+        //! @brief The values, column by column (run identifier excluded).
+        double const* data;
+        //! @brief The text (null for blocks of rows).
+        char const* text;
+        //! @brief Length of the text.
+        size_t length;
+
+        //! @brief Pointer to the values of a column (1 for the first column after the run identifier).
+        double const* column(size_t c) const {
+            return data + (c - 1) * rows;
+        }
+    };
+
+    //! @brief Maps the file at the given path.
+    explicit reader(std::string const& path) : m_file(path) {
+        m_base = m_file.data();
+        m_size = m_file.size();
+        if (m_size < sizeof(magic)) throw std::runtime_error("invalid columnar file " + path);
+        if (std::memcmp(m_base, magic, sizeof(magic)) != 0) throw std::runtime_error("invalid columnar file " + path);
+        size_t pos = sizeof(magic);
+        size_t columns = get(pos);
+        if (columns == 0) throw std::runtime_error("columnar file without columns");
+        for (size_t c = 0; c < columns; ++c) {
+            size_t len = get(pos);
+            if (len > m_size - pos) throw std::runtime_error("truncated columnar header");
+            m_names.emplace_back(m_base + pos, len);
+            pos += len;
+        }
+        pos = (pos + 7) / 8 * 8;
+        // one pass over the block headers, skipping the values
+        while (pos + 2 * sizeof(uint64_t) <= m_size) {
+            block b{0, 0, nullptr, nullptr, 0};
+            std::memcpy(&b.run, m_base + pos, sizeof(double));
+            pos += sizeof(double);
+            size_t rows = get(pos);
+            if (rows & text_flag) {
+                b.length = rows & ~text_flag;
+                if (b.length > m_size - pos) throw std::runtime_error("truncated columnar block");
+                b.text = m_base + pos;
+                pos = std::min(m_size, (pos + b.length + 7) / 8 * 8);
+                m_runs[b.run].push_back(m_blocks.size());
+                m_blocks.push_back(b);
+                continue;
+            }
+            b.rows = rows;
+            size_t width = sizeof(double) * (columns - 1);
+            if (width > 0 and b.rows > (m_size - pos) / width) throw std::runtime_error("truncated columnar block");
+            b.data = reinterpret_cast<double const*>(m_base + pos);
+            pos += b.rows * width;
+            m_runs[b.run].push_back(m_blocks.size());
+            m_blocks.push_back(b);
+            m_rows += b.rows;
+        }
+    }
+
+    reader(reader const&) = delete;
+    reader& operator=(reader const&) = delete;
+
+    //! @brief Number of rows.
+    size_t rows() const {
+        return m_rows;
+    }
+
+    //! @brief Number of columns (run identifier included).
+    size_t columns() const {
+        return m_names.size();
+    }
+
+    //! @brief Name of a column.
+    std::string const& name(size_t c) const {
+        return m_names[c];
+    }
+
+    //! @brief Index of a column given its name (`columns()` if not found).
+    size_t column(std::string const& name) const {
+        size_t c = 0;
+        while (c < m_names.size() and m_names[c] != name) ++c;
+        return c;
+    }
+
+    //! @brief The blocks, in file order.
+    std::vector<block> const& blocks() const {
+        return m_blocks;
+    }
+
+    //! @brief The indices of the blocks of every run, in file order, by run identifier.
+    std::map<double, std::vector<size_t>> const& runs() const {
+        return m_runs;
+    }
+
+  private:
+    //! @brief Reads a number.
+    size_t get(size_t& pos) const {
+        if (pos + sizeof(uint64_t) > m_size) throw std::runtime_error("truncated columnar header");
+        uint64_t x;
+        std::memcpy(&x, m_base + pos, sizeof(x));
+        pos += sizeof(x);
+        return x;
+    }
+
+    //! @brief The mapped file.
+    mapped_file m_file;
+    //! @brief The mapped memory.
+    char const* m_base = nullptr;
+    //! @brief Size of the mapped memory.
+    size_t m_size = 0;
+    //! @brief The column names.
+    std::vector<std::string> m_names;
+    //! @brief The blocks.
+    std::vector<block> m_blocks;
+    //! @brief The blocks of every run.
+    std::map<double, std::vector<size_t>> m_runs;
+    //! @brief Number of rows.
+    size_t m_rows = 0;
+};
+
+//! @brief Writes a run in the text format of FCPP: its text blocks as they are (header and footer), and a line per row in between.
+inline void to_text(reader const& in, double run, std::ostream& out) {
+    auto it = in.runs().find(run);
+    if (it == in.runs().end()) return;
+    for (size_t i : it->second) {
+        reader::block const& b = in.blocks()[i];
+        if (b.text != nullptr) {
+            out.write(b.text, b.length);
+            continue;
+        }
+        for (size_t r = 0; r < b.rows; ++r) {
+            for (size_t c = 1; c < in.columns(); ++c) out << (c > 1 ? " " : "") << b.column(c)[r];
+            out << "\n";
+        }
+    }
+}
+
+} // namespace columnar
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_COLUMNAR_H_
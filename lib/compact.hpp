@@ -0,0 +1,247 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file compact.hpp
+ * @brief Compact wire representations of exported values, enabled by compiling with `-DAP_COMPACT_EXPORTS=1`.
+ *
+ * Exported reals are quantised to fixed point (32 bits, `AP_COMPACT_FRACTION_BITS` fractional bits),
+ * and device identifiers are varint-encoded. Both convert implicitly from and to the plain types, so
+ * that only the exported types need to change.
+ */
+
+#ifndef CASE_STUDY_COMPACT_H_
+#define CASE_STUDY_COMPACT_H_
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "lib/fcpp.hpp"
+
+#ifndef AP_COMPACT_EXPORTS
+#define AP_COMPACT_EXPORTS 0
+#endif
+
+#ifndef AP_COMPACT_FRACTION_BITS
+#define AP_COMPACT_FRACTION_BITS 8
+#endif
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for compact wire representations.
+namespace compact {
+
+/**
+ * @brief A real number quantised to fixed point with F fractional bits.
+ *
+ * Values are rounded to the nearest multiple of 2^-F, so the absolute error is at most 2^-(F+1)
+ * within the range ±2^(31-F); infinities are saturated to the extremes of the range and back.
+ */
+template <int F>
+class fixed_real {
+  public:
+    //! @brief Default constructor (zero).
+    fixed_real() = default;
+
+    //! @brief Conversion from a real.
+    fixed_real(real_t x) {
+        if (x >= limit()) m_value = std::numeric_limits<int32_t>::max();
+        else if (x <= -limit()) m_value = std::numeric_limits<int32_t>::min();
+        else m_value = (int32_t)std::lround(x * (1 << F));
+    }
+
+    //! @brief Conversion to a real.
+    operator real_t() const {
+        if (m_value == std::numeric_limits<int32_t>::max()) return INF;
+        if (m_value == std::numeric_limits<int32_t>::min()) return -INF;
+        return m_value / real_t(1 << F);
+    }
+
+    //! @brief Serialises the content to/from a given input/output stream.
+    template <typename S>
+    S& serialize(S& s) {
+        return s & m_value;
+    }
+
+    //! @brief Serialises the content to a given output stream.
+    template <typename S>
+    S& serialize(S& s) const {
+        return s << m_value;
+    }
+
+  private:
+    //! @brief The largest representable magnitude.
+    static constexpr real_t limit() {
+        return std::numeric_limits<int32_t>::max() / real_t(1 << F);
+    }
+
+    //! @brief The quantised value.
+    int32_t m_value = 0;
+};
+
+//! @brief A device identifier, varint-encoded on the wire (LEB128, one byte for identifiers below 128).
+class varint_device {
+  public:
+    //! @brief Default constructor.
+    varint_device() = default;
+
+    //! @brief Conversion from a device identifier.
+    varint_device(device_t d) : m_value(d) {}
+
+    //! @brief Conversion to a device identifier.
+    operator device_t() const {
+        return m_value;
+    }
+
+    //! @brief Serialises the content from a given input stream.
+    common::isstream& serialize(common::isstream& s) {
+        uint64_t v = 0;
+        uint8_t b;
+        int shift = 0;
+        do {
+            s >> b;
+            v |= uint64_t(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        m_value = (device_t)v;
+        return s;
+    }
+
+    //! @brief Serialises the content to a given output stream.
+    common::osstream& serialize(common::osstream& s) const {
+        uint64_t v = m_value;
+        do {
+            uint8_t b = v & 0x7F;
+            v >>= 7;
+            if (v) b |= 0x80;
+            s << b;
+        } while (v);
+        return s;
+    }
+
+  private:
+    //! @brief The device identifier.
+    device_t m_value = 0;
+};
+
+//! @brief The wire representation of a type (the type itself by default).
+template <typename T>
+struct wire {
+    using type = T;
+};
+
+#if AP_COMPACT_EXPORTS
+//! @brief Reals are quantised on the wire.
+template <>
+struct wire<real_t> {
+    using type = fixed_real<AP_COMPACT_FRACTION_BITS>;
+};
+
+//! @brief Device identifiers are varint-encoded on the wire.
+template <>
+struct wire<device_t> {
+    using type = varint_device;
+};
+#endif
+
+//! @brief The wire representation of a type.
+template <typename T>
+using wire_t = typename wire<T>::type;
+
+/**
+ * @brief Number of bytes of the wire representation of a value, computed without serialising it.
+ *
+ * Arithmetic values and fixed-point reals take their width, varint identifiers the number of their
+ * 7-bit groups, arrays and tuples the sum of their elements. Fields take an identifier and a value for
+ * every neighbour, plus the default value (container length headers are not counted). Other types are
+ * measured by serialising them into a buffer.
+ */
+template <typename T>
+size_t wire_size(T const& x);
+
+template <int F>
+size_t wire_size(fixed_real<F> const&);
+
+inline size_t wire_size(varint_device const& x);
+
+template <typename T, size_t N>
+size_t wire_size(std::array<T, N> const& x);
+
+template <typename... Ts>
+size_t wire_size(tuple<Ts...> const& x);
+
+template <typename T>
+size_t wire_size(field<T> const& x);
+
+//! @brief Number of bytes of a fixed-point real on the wire.
+template <int F>
+size_t wire_size(fixed_real<F> const&) {
+    return sizeof(int32_t);
+}
+
+//! @brief Number of bytes of a varint identifier on the wire.
+inline size_t wire_size(varint_device const& x) {
+    size_t n = 1;
+    for (uint64_t v = device_t(x); v >= 0x80; v >>= 7) ++n;
+    return n;
+}
+
+//! @brief Number of bytes of an array on the wire.
+template <typename T, size_t N>
+size_t wire_size(std::array<T, N> const& x) {
+    size_t n = 0;
+    for (T const& y : x) n += wire_size(y);
+    return n;
+}
+
+//! @brief Implementation details.
+namespace details {
+    //! @brief Sum of the wire sizes of the elements of a tuple.
+    template <typename T, size_t... Is>
+    size_t tuple_wire_size(T const& x, std::index_sequence<Is...>) {
+        return (size_t(0) + ... + wire_size(get<Is>(x)));
+    }
+}
+
+//! @brief Number of bytes of a tuple on the wire.
+template <typename... Ts>
+size_t wire_size(tuple<Ts...> const& x) {
+    return details::tuple_wire_size(x, std::make_index_sequence<sizeof...(Ts)>{});
+}
+
+//! @brief Number of bytes of a field on the wire (an identifier and a value per neighbour, and the default).
+template <typename T>
+size_t wire_size(field<T> const& x) {
+    std::vector<T> const& vals = fcpp::details::get_vals(x);
+    size_t n = fcpp::details::get_ids(x).size() * sizeof(device_t);
+    if constexpr (std::is_arithmetic<T>::value) {
+        n += vals.size() * sizeof(T);
+    } else {
+        for (T const& v : vals) n += wire_size(v);
+    }
+    return n;
+}
+
+template <typename T>
+size_t wire_size(T const& x) {
+    if constexpr (std::is_arithmetic<T>::value) {
+        return sizeof(T);
+    } else {
+        common::osstream s;
+        s << x;
+        return s.size();
+    }
+}
+
+} // namespace compact
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_COMPACT_H_
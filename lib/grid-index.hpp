@@ -0,0 +1,154 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file grid-index.hpp
+ * @brief Uniform-grid (cell list) index for neighbour discovery among spatially distributed nodes.
+ *
+ * Positions are bucketed into cubic cells whose side is the maximum communication range, so that
+ * the only candidate neighbours of a node are those in the 3^dim cells around its own. The index
+ * only prunes candidates by distance: the connection predicate is still applied by the caller.
+ */
+
+#ifndef CASE_STUDY_GRID_INDEX_H_
+#define CASE_STUDY_GRID_INDEX_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for spatial indexing utilities.
+namespace spatial {
+
+/**
+ * @brief Cell-list index over a fixed set of positions.
+ *
+ * @param dim The dimensionality of the space.
+ */
+template <size_t dim = 2>
+class grid_index {
+  public:
+    //! @brief The type of a point in space.
+    using point_type = std::array<double, dim>;
+
+    //! @brief Constructor given the cell side (usually the communication range).
+    explicit grid_index(double cell_size) : m_cell_size(cell_size) {}
+
+    //! @brief The side of a cell.
+    double cell_size() const {
+        return m_cell_size;
+    }
+
+    //! @brief Number of indexed points.
+    size_t size() const {
+        return m_cell_of.size();
+    }
+
+    /**
+     * @brief Indexes the given points (counting sort into cells, linear time).
+     *
+     * @param n The number of points.
+     * @param pos Functor returning the position of a point given its index, as something indexable by dimension.
+     */
+    template <typename F>
+    void build(size_t n, F&& pos) {
+        m_lo.fill(std::numeric_limits<double>::max());
+        point_type hi;
+        hi.fill(std::numeric_limits<double>::lowest());
+        for (size_t i = 0; i < n; ++i) {
+            auto const& p = pos(i);
+            for (size_t d = 0; d < dim; ++d) {
+                m_lo[d] = std::min<double>(m_lo[d], p[d]);
+                hi[d] = std::max<double>(hi[d], p[d]);
+            }
+        }
+        size_t cells = 1;
+        for (size_t d = 0; d < dim; ++d) {
+            m_side[d] = n == 0 ? 1 : size_t((hi[d] - m_lo[d]) / m_cell_size) + 1;
+            cells *= m_side[d];
+        }
+        m_cell_of.resize(n);
+        m_start.assign(cells + 1, 0);
+        for (size_t i = 0; i < n; ++i) {
+            m_cell_of[i] = cell_of(pos(i));
+            ++m_start[m_cell_of[i] + 1];
+        }
+        for (size_t c = 0; c < cells; ++c)
+            m_start[c + 1] += m_start[c];
+        m_items.resize(n);
+        std::vector<size_t> fill(m_start.begin(), m_start.end() - 1);
+        for (size_t i = 0; i < n; ++i)
+            m_items[fill[m_cell_of[i]]++] = i;
+    }
+
+    /**
+     * @brief Calls `f(j)` for every indexed point j in the cells adjacent to the one of point i (i included).
+     *
+     * Every point within `cell_size()` from point i is guaranteed to be visited, in increasing cell order.
+     */
+    template <typename F>
+    void for_each_candidate(size_t i, F&& f) const {
+        std::array<size_t, dim> c = coords(m_cell_of[i]);
+        std::array<size_t, dim> lo, hi, k;
+        for (size_t d = 0; d < dim; ++d) {
+            lo[d] = c[d] > 0 ? c[d] - 1 : 0;
+            hi[d] = std::min(c[d] + 1, m_side[d] - 1);
+        }
+        k = lo;
+        while (true) {
+            size_t cell = 0;
+            for (size_t d = dim; d-- > 0;) cell = cell * m_side[d] + k[d];
+            for (size_t x = m_start[cell]; x < m_start[cell + 1]; ++x) f(m_items[x]);
+            size_t d = 0;
+            while (d < dim and k[d] == hi[d]) k[d] = lo[d], ++d;
+            if (d == dim) break;
+            ++k[d];
+        }
+    }
+
+  private:
+    //! @brief Cell containing a position.
+    template <typename P>
+    size_t cell_of(P const& p) const {
+        size_t cell = 0;
+        for (size_t d = dim; d-- > 0;)
+            cell = cell * m_side[d] + std::min(size_t((p[d] - m_lo[d]) / m_cell_size), m_side[d] - 1);
+        return cell;
+    }
+
+    //! @brief Grid coordinates of a cell.
+    std::array<size_t, dim> coords(size_t cell) const {
+        std::array<size_t, dim> c;
+        for (size_t d = 0; d < dim; ++d) {
+            c[d] = cell % m_side[d];
+            cell /= m_side[d];
+        }
+        return c;
+    }
+
+    //! @brief The side of a cell.
+    double m_cell_size;
+    //! @brief Lower corner of the indexed area.
+    point_type m_lo;
+    //! @brief Number of cells on every side.
+    std::array<size_t, dim> m_side;
+    //! @brief Cell of every point.
+    std::vector<size_t> m_cell_of;
+    //! @brief Start offset in `m_items` for every cell (CSR layout).
+    std::vector<size_t> m_start;
+    //! @brief Points sorted by cell.
+    std::vector<size_t> m_items;
+};
+
+} // namespace spatial
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_GRID_INDEX_H_
@@ -0,0 +1,100 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file mapped-file.hpp
+ * @brief Read-only memory-mapped files, shared by the readers of columnar files and traces.
+ *
+ * Pages are loaded by the operating system as they are read, so scanning a file does not copy it
+ * in memory first. On platforms without `mmap`, the file is read in a buffer instead.
+ */
+
+#ifndef CASE_STUDY_MAPPED_FILE_H_
+#define CASE_STUDY_MAPPED_FILE_H_
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Read-only view of the content of a file.
+class mapped_file {
+  public:
+    //! @brief Maps the file at the given path, hinting whether it is read sequentially.
+    explicit mapped_file(std::string const& path, bool sequential = false) {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot open " + path);
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot open " + path);
+        }
+        m_size = st.st_size;
+        if (m_size > 0) {
+            void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("cannot map " + path);
+            }
+            if (sequential) madvise(p, m_size, MADV_SEQUENTIAL);
+            m_data = static_cast<char const*>(p);
+        }
+        ::close(fd);
+#else
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (f == nullptr) throw std::runtime_error("cannot open " + path);
+        char buf[1 << 16];
+        size_t n;
+        while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) m_buffer.insert(m_buffer.end(), buf, buf + n);
+        std::fclose(f);
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+        (void)sequential;
+#endif
+    }
+
+    mapped_file(mapped_file const&) = delete;
+    mapped_file& operator=(mapped_file const&) = delete;
+
+    ~mapped_file() {
+#ifndef _WIN32
+        if (m_data != nullptr) munmap(const_cast<char*>(m_data), m_size);
+#endif
+    }
+
+    //! @brief The content of the file.
+    char const* data() const {
+        return m_data;
+    }
+
+    //! @brief Size of the file.
+    size_t size() const {
+        return m_size;
+    }
+
+  private:
+    //! @brief The content of the file.
+    char const* m_data = nullptr;
+    //! @brief Size of the file.
+    size_t m_size = 0;
+#ifdef _WIN32
+    //! @brief The content of the file, where it cannot be mapped.
+    std::vector<char> m_buffer;
+#endif
+};
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_MAPPED_FILE_H_
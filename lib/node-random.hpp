@@ -0,0 +1,62 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file node-random.hpp
+ * @brief Counter-based per-node random streams, independent of the order in which node rounds are executed.
+ *
+ * The k-th draw of a node in a round only depends on the node key, the round number and k, so that
+ * the values drawn in an aggregate program are the same whether rounds run serially or in parallel.
+ */
+
+#ifndef CASE_STUDY_NODE_RANDOM_H_
+#define CASE_STUDY_NODE_RANDOM_H_
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for counter-based random streams.
+namespace node_random {
+
+//! @brief SplitMix64 finaliser, a bijective mixing of 64 bits.
+inline uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+//! @brief Turns a real drawn at node creation into a stream key.
+inline uint64_t key(double x) {
+    uint64_t k;
+    std::memcpy(&k, &x, sizeof(k));
+    return mix(k);
+}
+
+//! @brief The k-th uniform real in [0,1) of a given round in the stream of a key.
+inline double uniform(uint64_t key, uint64_t round, uint64_t k = 0) {
+    uint64_t z = mix(key + 0x9E3779B97F4A7C15ULL * (round * 4 + k + 1));
+    return (z >> 11) * 0x1.0p-53;
+}
+
+//! @brief Random generator seeded by a (round, sender, receiver) triple, so that link draws do not depend on evaluation order.
+struct pair_generator {
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+    pair_generator(uint64_t r, uint64_t i, uint64_t j) : m_state(r * 0x9E3779B97F4A7C15ULL ^ i * 0xC2B2AE3D27D4EB4FULL ^ j * 0x165667B19E3779F9ULL) {}
+    //! @brief SplitMix64 step.
+    result_type operator()() {
+        return mix(m_state += 0x9E3779B97F4A7C15ULL);
+    }
+    uint64_t m_state;
+};
+
+} // namespace node_random
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_NODE_RANDOM_H_
@@ -0,0 +1,193 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file parallel-batch.hpp
+ * @brief Seed-sharded multi-core executor for batches of simulations.
+ *
+ * The runs of a batch are split into fixed-size chunks of consecutive indices. Every chunk owns its
+ * plotter shard, and worker threads steal whole chunks from each other. Shards are merged (and freed)
+ * in chunk order as soon as all the previous chunks are merged: since both the chunking and the merge
+ * order only depend on the batch size, the merged plot is the same for any thread count.
+ */
+
+#ifndef CASE_STUDY_PARALLEL_BATCH_H_
+#define CASE_STUDY_PARALLEL_BATCH_H_
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "lib/fcpp.hpp"
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for batch simulation utilities.
+namespace batch {
+
+//! @brief Timing statistics collected by a sharded batch execution.
+struct shard_report {
+    //! @brief Wall-clock time of the whole batch (seconds).
+    double wall_time = 0;
+    //! @brief Time spent running simulations, for every worker (seconds).
+    std::vector<double> busy_time;
+    //! @brief Number of runs executed, for every worker.
+    std::vector<size_t> runs;
+    //! @brief Number of chunks stolen from other workers, for every worker.
+    std::vector<size_t> steals;
+
+    //! @brief Total number of runs executed.
+    size_t total_runs() const {
+        size_t s = 0;
+        for (size_t r : runs) s += r;
+        return s;
+    }
+
+    /**
+     * @brief Fraction of the worker time spent running simulations (total busy time over workers times wall-clock time).
+     *
+     * It is not a speedup: runs slowed down by contention for memory and caches still count as busy.
+     */
+    double utilisation() const {
+        double s = 0;
+        for (double t : busy_time) s += t;
+        return wall_time > 0 and not busy_time.empty() ? s / (wall_time * busy_time.size()) : 0;
+    }
+
+    //! @brief Prints the report in a human-readable format.
+    friend std::ostream& operator<<(std::ostream& o, shard_report const& r) {
+        size_t w = r.runs.size();
+        o << std::fixed << std::setprecision(3);
+        o << "batch: " << r.total_runs() << " runs on " << w << " workers in " << r.wall_time << "s ("
+          << (r.wall_time > 0 ? r.total_runs() / r.wall_time : 0) << " runs/s)\n";
+        for (size_t i = 0; i < w; ++i)
+            o << "  worker " << i << ": " << r.runs[i] << " runs, " << r.steals[i] << " steals, busy "
+              << r.busy_time[i] << "s (" << (r.wall_time > 0 ? 100 * r.busy_time[i] / r.wall_time : 0) << "%)\n";
+        o << "  utilisation " << 100 * r.utilisation() << "% (" << r.utilisation() * w << " workers busy on average)\n";
+        o.unsetf(std::ios_base::floatfield);
+        return o;
+    }
+};
+
+/**
+ * @brief Runs a sequence of simulations on a work-stealing thread pool, with one plotter shard per chunk of runs.
+ *
+ * Every run is executed by `run`, given the shard of the chunk it belongs to, and the shards are merged
+ * into `plotter` in chunk order. Only the shards of chunks running or completed out of order are kept
+ * in memory at any time.
+ *
+ * @param x A component type, whose `net` is constructed from every element of the sequence.
+ * @param plotter The plotter receiving the merged results.
+ * @param v A sequence of tagged tuples of initialisation values (with a `plotter` entry).
+ * @param threads The number of worker threads (zero for the hardware concurrency).
+ * @param chunk The number of consecutive runs sharing a plotter shard.
+ * @param run Executes a run given its initialisation values, plotter shard and index in the sequence.
+ * @param merged_runs Called with the number of runs merged so far after every merge, while no other merge can happen.
+ */
+template <typename T, typename P, typename S, typename R, typename M>
+shard_report sharded_run(T, P& plotter, S const& v, size_t threads, size_t chunk, R&& run, M&& merged_runs) {
+    using clock_t = std::chrono::steady_clock;
+    if (threads == 0) threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    chunk = std::max<size_t>(chunk, 1);
+    size_t chunks = (v.size() + chunk - 1) / chunk;
+    threads = std::max<size_t>(std::min(threads, chunks), 1);
+
+    std::vector<std::unique_ptr<P>> shards(chunks);
+    std::vector<bool> done(chunks, false);
+    size_t merged = 0;
+    std::mutex merge_lock;
+    // initial contiguous distribution of chunks among workers
+    std::vector<std::deque<size_t>> queues(threads);
+    std::vector<std::mutex> locks(threads);
+    for (size_t c = 0; c < chunks; ++c)
+        queues[c * threads / chunks].push_back(c);
+
+    shard_report report;
+    report.busy_time.assign(threads, 0);
+    report.runs.assign(threads, 0);
+    report.steals.assign(threads, 0);
+
+    // pops from the front of the own queue, or steals from the back of the others
+    auto next_chunk = [&](size_t w, size_t& c) {
+        {
+            std::lock_guard<std::mutex> l(locks[w]);
+            if (not queues[w].empty()) {
+                c = queues[w].front();
+                queues[w].pop_front();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < threads; ++k) {
+            size_t o = (w + k) % threads;
+            std::lock_guard<std::mutex> l(locks[o]);
+            if (not queues[o].empty()) {
+                c = queues[o].back();
+                queues[o].pop_back();
+                ++report.steals[w];
+                return true;
+            }
+        }
+        return false;
+    };
+    auto worker = [&](size_t w) {
+        size_t c;
+        while (next_chunk(w, c)) {
+            auto start = clock_t::now();
+            std::unique_ptr<P> shard = std::make_unique<P>();
+            for (size_t i = c * chunk; i < std::min((c + 1) * chunk, v.size()); ++i) {
+                run(v[i], *shard, i);
+                ++report.runs[w];
+            }
+            report.busy_time[w] += std::chrono::duration<double>(clock_t::now() - start).count();
+            // deterministic merge, independent of which worker ran which chunk
+            std::lock_guard<std::mutex> l(merge_lock);
+            shards[c] = std::move(shard);
+            done[c] = true;
+            size_t first = merged;
+            for (; merged < chunks and done[merged]; ++merged) {
+                plotter += *shards[merged];
+                shards[merged].reset();
+            }
+            if (merged > first) merged_runs(std::min(merged * chunk, v.size()));
+        }
+    };
+
+    auto start = clock_t::now();
+    std::vector<std::thread> pool;
+    for (size_t w = 1; w < threads; ++w) pool.emplace_back(worker, w);
+    worker(0);
+    for (std::thread& t : pool) t.join();
+    report.wall_time = std::chrono::duration<double>(clock_t::now() - start).count();
+    return report;
+}
+
+//! @brief Runs a sequence of simulations on a work-stealing thread pool, with one plotter shard per chunk of runs.
+template <typename T, typename P, typename S, typename R>
+shard_report sharded_run(T x, P& plotter, S const& v, size_t threads, size_t chunk, R&& run) {
+    return sharded_run(x, plotter, v, threads, chunk, std::forward<R>(run), [](size_t){});
+}
+
+//! @brief Runs a sequence of simulations on a work-stealing thread pool, with the plotter shard set as plotter of each run.
+template <typename T, typename P, typename S>
+shard_report sharded_run(T x, P& plotter, S const& v, size_t threads = 0, size_t chunk = 8) {
+    return sharded_run(x, plotter, v, threads, chunk, [](auto t, P& shard, size_t){
+        common::get<component::tags::plotter>(t) = &shard;
+        typename T::net network{t};
+        network.run();
+    });
+}
+
+} // namespace batch
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_PARALLEL_BATCH_H_
@@ -0,0 +1,89 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file profiler.hpp
+ * @brief Low-overhead per-call profiling of aggregate functions, enabled by compiling with `-DAP_PROFILE=1`.
+ *
+ * Profiled calls accumulate their cycle count and number of invocations in the node storage,
+ * under the `profile_cycles<F>` and `profile_calls<F>` tags for a function tag `F`. When profiling
+ * is disabled, `AP_PROFILED(F, expr)` expands to `expr` and nothing else is compiled in.
+ */
+
+#ifndef CASE_STUDY_PROFILER_H_
+#define CASE_STUDY_PROFILER_H_
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef AP_PROFILE
+#define AP_PROFILE 0
+#endif
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace containing the libraries of coordination routines.
+namespace coordination {
+
+//! @brief Tags used in the node storage.
+namespace tags {
+    //! @brief Cycles spent in calls to a function during the last round.
+    template <typename>
+    struct profile_cycles {};
+    //! @brief Number of calls to a function during the last round.
+    template <typename>
+    struct profile_calls {};
+}
+
+} // namespace coordination
+
+//! @brief Namespace for profiling utilities.
+namespace profiler {
+
+//! @brief Current value of the cycle counter (nanoseconds where no cycle counter is available).
+inline uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+//! @brief Clears the profile counters of the given function tags, at the start of a round.
+template <typename... Fs, typename node_t>
+inline void reset(node_t& node) {
+    ((node.storage(coordination::tags::profile_cycles<Fs>{}) = 0), ...);
+    ((node.storage(coordination::tags::profile_calls<Fs>{}) = 0), ...);
+}
+
+//! @brief Calls a function, adding its cycles and invocation to the profile counters of tag F.
+template <typename F, typename node_t, typename G>
+inline auto call(node_t& node, G&& f) {
+    uint64_t start = cycles();
+    auto r = f();
+    node.storage(coordination::tags::profile_cycles<F>{}) += cycles() - start;
+    node.storage(coordination::tags::profile_calls<F>{}) += 1;
+    return r;
+}
+
+} // namespace profiler
+
+} // namespace fcpp
+
+#if AP_PROFILE
+//! @brief Evaluates an expression within an aggregate function, profiling it under the function tag F.
+#define AP_PROFILED(F, ...)         fcpp::profiler::call<F>(node, [&](){ return __VA_ARGS__; })
+//! @brief Clears the profile counters of the given function tags.
+#define AP_PROFILE_RESET(...)       fcpp::profiler::reset<__VA_ARGS__>(node)
+#else
+#define AP_PROFILED(F, ...)         __VA_ARGS__
+#define AP_PROFILE_RESET(...)
+#endif
+
+#endif // CASE_STUDY_PROFILER_H_
@@ -0,0 +1,246 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file retention.hpp
+ * @brief Bounded message retention, with a fixed capacity per node and selectable eviction policies.
+ *
+ * A store holds at most `capacity` neighbour messages, in slots allocated once. Messages are offered
+ * to the store when they arrive: a message from a new sender arriving at a full store takes the slot
+ * of the message chosen by the policy, while a newer message of a sender already held replaces the
+ * previous one in its slot. A message that is not held when it arrives is lost, so the store keeps
+ * no state about the senders it does not hold. Slots are found through an open-addressing index by
+ * sender, so that offering a message takes constant time also without a bound. The memory of a store
+ * counts the slots, the index and the payload of the messages held.
+ */
+
+#ifndef CASE_STUDY_RETENTION_H_
+#define CASE_STUDY_RETENTION_H_
+
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+#include "lib/fcpp.hpp"
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for bounded message retention.
+namespace retention {
+
+//! @brief A retained message.
+struct entry {
+    //! @brief The sender.
+    device_t uid;
+    //! @brief The version of the message of the sender (such as the round that produced it).
+    uint32_t round;
+    //! @brief The payload bytes of the message.
+    uint32_t bytes;
+    //! @brief Arrival counter of the message in the store.
+    uint64_t stamp;
+};
+
+//! @brief Evicts the message that arrived first.
+struct oldest_first {
+    template <typename R>
+    size_t victim(std::vector<entry> const& e, R&&) const {
+        size_t v = 0;
+        for (size_t k = 1; k < e.size(); ++k)
+            if (e[k].stamp < e[v].stamp) v = k;
+        return v;
+    }
+};
+
+//! @brief Evicts the message of the sender with the lowest rating (the oldest among equal ratings).
+struct lowest_rating_first {
+    template <typename R>
+    size_t victim(std::vector<entry> const& e, R&& rating) const {
+        size_t v = 0;
+        real_t rv = rating(e[0].uid);
+        for (size_t k = 1; k < e.size(); ++k) {
+            real_t rk = rating(e[k].uid);
+            if (rk < rv or (rk == rv and e[k].stamp < e[v].stamp)) v = k, rv = rk;
+        }
+        return v;
+    }
+};
+
+/**
+ * @brief Retention store of a node.
+ *
+ * @param P The eviction policy.
+ */
+template <typename P>
+class store {
+  public:
+    //! @brief Constructor given the capacity (unbounded by default) and the policy.
+    explicit store(size_t capacity = std::numeric_limits<size_t>::max(), P policy = {}) : m_capacity(capacity), m_policy(policy) {
+        if (capacity < 1024) {
+            m_slots.reserve(capacity);
+            rehash(capacity);
+        }
+    }
+
+    /**
+     * @brief Offers a message arriving at the store.
+     *
+     * @param uid The sender.
+     * @param round The version of the message (such as the round of the sender that produced it).
+     * @param bytes The payload bytes of the message.
+     * @param rating Function giving the rating of a sender (used by rating-based policies).
+     * @return Whether the message is retained.
+     */
+    template <typename R>
+    bool offer(device_t uid, uint32_t round, size_t bytes, R&& rating) {
+        size_t k = find(uid);
+        if (k < m_slots.size()) {
+            if (m_slots[k].round != round) set(k, {uid, round, (uint32_t)bytes, m_stamp++});
+            return true;
+        }
+        if (m_capacity == 0) return false;
+        if (m_slots.size() < m_capacity) {
+            if (2 * (m_slots.size() + 1) > m_index.size()) rehash(m_slots.size() + 1);
+            m_slots.push_back({uid, round, (uint32_t)bytes, m_stamp++});
+            m_payload += bytes;
+            insert(m_slots.size() - 1);
+        } else {
+            k = m_policy.victim(m_slots, rating);
+            erase(m_slots[k].uid);
+            set(k, {uid, round, (uint32_t)bytes, m_stamp++});
+            insert(k);
+            ++m_evictions;
+        }
+        return true;
+    }
+
+    //! @brief Forgets the senders for which `keep(uid)` is false (whose messages expired).
+    template <typename K>
+    void expire(K&& keep) {
+        for (size_t k = 0; k < m_slots.size();) {
+            if (keep(m_slots[k].uid)) {
+                ++k;
+                continue;
+            }
+            erase(m_slots[k].uid);
+            m_payload -= m_slots[k].bytes;
+            if (k + 1 < m_slots.size()) {
+                m_slots[k] = m_slots.back();
+                m_index[bucket(m_slots[k].uid)] = k + 1;
+            }
+            m_slots.pop_back();
+        }
+    }
+
+    //! @brief Whether the store holds the given message.
+    bool holds(device_t uid, uint32_t round) const {
+        size_t k = find(uid);
+        return k < m_slots.size() and m_slots[k].round == round;
+    }
+
+    //! @brief Number of messages held.
+    size_t size() const {
+        return m_slots.size();
+    }
+
+    //! @brief Number of bytes allocated for the slots and the index, and of the payload of the messages held.
+    size_t bytes() const {
+        return m_slots.capacity() * sizeof(entry) + m_index.capacity() * sizeof(uint32_t) + m_payload;
+    }
+
+    //! @brief Number of messages evicted so far.
+    size_t evictions() const {
+        return m_evictions;
+    }
+
+    //! @brief Prints a summary of the store (as node storage).
+    friend std::ostream& operator<<(std::ostream& o, store const& s) {
+        return o << s.size() << " held, " << s.evictions() << " evicted";
+    }
+
+  private:
+    //! @brief Writes an entry in a slot, updating the payload bytes.
+    void set(size_t k, entry e) {
+        m_payload += e.bytes;
+        m_payload -= m_slots[k].bytes;
+        m_slots[k] = e;
+    }
+
+    //! @brief The home position of a sender in the index (Fibonacci hashing).
+    size_t home(device_t uid) const {
+        return (uint64_t(uid) * 0x9E3779B97F4A7C15ULL) >> m_shift;
+    }
+
+    //! @brief The position of a sender held in the index.
+    size_t bucket(device_t uid) const {
+        size_t mask = m_index.size() - 1;
+        size_t b = home(uid);
+        while (m_slots[m_index[b] - 1].uid != uid) b = (b + 1) & mask;
+        return b;
+    }
+
+    //! @brief The slot of a sender (the number of messages held if not found).
+    size_t find(device_t uid) const {
+        if (m_index.empty()) return m_slots.size();
+        size_t mask = m_index.size() - 1;
+        for (size_t b = home(uid); m_index[b]; b = (b + 1) & mask)
+            if (m_slots[m_index[b] - 1].uid == uid) return m_index[b] - 1;
+        return m_slots.size();
+    }
+
+    //! @brief Adds the sender of a slot to the index.
+    void insert(size_t k) {
+        size_t mask = m_index.size() - 1;
+        size_t b = home(m_slots[k].uid);
+        while (m_index[b]) b = (b + 1) & mask;
+        m_index[b] = k + 1;
+    }
+
+    //! @brief Removes a sender held from the index, shifting back the senders after it (linear probing).
+    void erase(device_t uid) {
+        size_t mask = m_index.size() - 1;
+        size_t i = bucket(uid);
+        for (size_t j = (i + 1) & mask; m_index[j]; j = (j + 1) & mask) {
+            size_t h = home(m_slots[m_index[j] - 1].uid);
+            if (((j - h) & mask) >= ((j - i) & mask)) {
+                m_index[i] = m_index[j];
+                i = j;
+            }
+        }
+        m_index[i] = 0;
+    }
+
+    //! @brief Resizes the index for n senders, to at most half load.
+    void rehash(size_t n) {
+        size_t size = 8;
+        m_shift = 61;
+        while (size < 2 * n) size *= 2, --m_shift;
+        m_index.assign(size, 0);
+        for (size_t k = 0; k < m_slots.size(); ++k) insert(k);
+    }
+
+    //! @brief The maximum number of messages held.
+    size_t m_capacity;
+    //! @brief The eviction policy.
+    P m_policy;
+    //! @brief The messages held, in no particular order.
+    std::vector<entry> m_slots;
+    //! @brief The slot of every sender held plus one, by position of the sender (zero for free positions).
+    std::vector<uint32_t> m_index;
+    //! @brief Shift giving the home position of a sender from its hash.
+    unsigned m_shift = 64;
+    //! @brief Payload bytes of the messages held.
+    size_t m_payload = 0;
+    //! @brief The arrival counter.
+    uint64_t m_stamp = 0;
+    //! @brief Number of messages evicted so far.
+    size_t m_evictions = 0;
+};
+
+} // namespace retention
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_RETENTION_H_
@@ -0,0 +1,574 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file soa-engine.hpp
+ * @brief Data-oriented synchronous engine for the case study, executing the rounds of all nodes in a single sweep.
+ *
+ * Node values are laid out as structure-of-arrays, double-buffered so that every round reads the
+ * exports of the previous round only. Field values are stored per edge, in a static CSR adjacency
+ * holding for every node the candidate senders within communication range. Every edge also holds a
+ * copy of the last message delivered over it, with the round it was sent in: a message is used for
+ * `window` rounds after it was sent, unless a newer one replaces it, as messages retained by FCPP
+ * nodes (`retain<metric::retain<5,1>>` in the case study, with rounds every second). Once delivered,
+ * neighbour reductions are loops over contiguous edge ranges, and every rating is reduced in its
+ * own pass.
+ *
+ * The program is the one of `MAIN` (abf_distance, the three connection ratings, sp_collection and
+ * ssp_collection with the geometric battery model, gateways and their root rules), with synchronous
+ * rounds: a node receives in round r the messages sent in round r-1 over the links delivered in
+ * round r. The `soa_equivalence` test checks it against `MAIN` run by FCPP on the same links.
+ */
+
+#ifndef CASE_STUDY_SOA_ENGINE_H_
+#define CASE_STUDY_SOA_ENGINE_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "lib/fcpp.hpp"
+#include "lib/battery.hpp"
+#include "lib/grid-index.hpp"
+#include "lib/node-random.hpp"
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for the structure-of-arrays engine.
+namespace soa {
+
+//! @brief Persistent worker threads, splitting loops over nodes in contiguous ranges.
+class worker_pool {
+  public:
+    //! @brief Number of iterations below which loops are run by the calling thread alone.
+    static constexpr size_t min_parallel = 1024;
+
+    //! @brief Starts the workers (the calling thread acts as one of the given number of threads).
+    explicit worker_pool(size_t threads) : m_threads(std::max<size_t>(threads, 1)) {
+        for (size_t t = 1; t < m_threads; ++t) m_workers.emplace_back([this, t](){ work(t); });
+    }
+
+    worker_pool(worker_pool const&) = delete;
+    worker_pool& operator=(worker_pool const&) = delete;
+
+    ~worker_pool() {
+        {
+            std::lock_guard<std::mutex> l(m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+        for (std::thread& t : m_workers) t.join();
+    }
+
+    //! @brief Number of threads.
+    size_t size() const {
+        return m_threads;
+    }
+
+    //! @brief Calls `f(i)` for every `i < n`, returning once all calls have completed.
+    template <typename F>
+    void run(size_t n, F&& f) {
+        if (m_threads == 1 or n < min_parallel) {
+            for (size_t i = 0; i < n; ++i) f(i);
+            return;
+        }
+        auto task = [&f, n, this](size_t t){
+            for (size_t i = t * n / m_threads; i < (t + 1) * n / m_threads; ++i) f(i);
+        };
+        {
+            std::lock_guard<std::mutex> l(m_mutex);
+            m_task = &task;
+            m_call = [](void const* p, size_t t){
+                (*static_cast<decltype(task) const*>(p))(t);
+            };
+            m_pending = m_threads - 1;
+            ++m_generation;
+        }
+        m_start.notify_all();
+        task(0);
+        std::unique_lock<std::mutex> l(m_mutex);
+        m_done.wait(l, [this](){ return m_pending == 0; });
+    }
+
+  private:
+    //! @brief Loop of worker t, running its range of every task.
+    void work(size_t t) {
+        size_t generation = 0;
+        while (true) {
+            void const* task;
+            void (*call)(void const*, size_t);
+            {
+                std::unique_lock<std::mutex> l(m_mutex);
+                m_start.wait(l, [&](){ return m_stop or m_generation != generation; });
+                if (m_stop) return;
+                generation = m_generation;
+                task = m_task;
+                call = m_call;
+            }
+            call(task, t);
+            std::lock_guard<std::mutex> l(m_mutex);
+            if (--m_pending == 0) m_done.notify_one();
+        }
+    }
+
+    //! @brief The number of threads.
+    size_t m_threads;
+    //! @brief The worker threads.
+    std::vector<std::thread> m_workers;
+    //! @brief Guards the task and the counters.
+    std::mutex m_mutex;
+    //! @brief Signals a new task, or termination.
+    std::condition_variable m_start;
+    //! @brief Signals the completion of a task by every worker.
+    std::condition_variable m_done;
+    //! @brief The current task.
+    void const* m_task = nullptr;
+    //! @brief Runs the range of a worker in the current task.
+    void (*m_call)(void const*, size_t) = nullptr;
+    //! @brief Number of tasks started.
+    size_t m_generation = 0;
+    //! @brief Number of workers still running the current task.
+    size_t m_pending = 0;
+    //! @brief Whether the workers have to terminate.
+    bool m_stop = false;
+};
+
+/**
+ * @brief Synchronous structure-of-arrays engine for the case study (nodes below `gateway_num` are the sources).
+ *
+ * @param dim The dimensionality of the space.
+ */
+template <size_t dim = 2>
+class engine {
+  public:
+    //! @brief The type of a point in space.
+    using point_type = std::array<double, dim>;
+
+    //! @brief Number of rating fields (uniconn, biconn, mixed).
+    static constexpr size_t K = 3;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param positions The (fixed) positions of the nodes.
+     * @param range The communication range.
+     * @param seeds The seeds of the random streams of the nodes.
+     * @param levels The initial battery levels of the nodes.
+     * @param stale_factor The stale factor of ssp_collection.
+     * @param model The battery model.
+     * @param gateway_num The number of gateways (at most the number of nodes).
+     * @param window The number of rounds for which a message is used after the round it was sent in.
+     * @param threads The number of threads sweeping over nodes.
+     */
+    engine(std::vector<point_type> positions, double range, std::vector<double> const& seeds, std::vector<int> levels, real_t stale_factor, battery::geometric model, device_t gateway_num, size_t window, size_t threads = 1)
+    : m_positions(std::move(positions)), m_level(std::move(levels)), m_stale_factor(stale_factor), m_model(model),
+      m_gateway_num(std::min<size_t>(gateway_num, m_positions.size())), m_window(window), m_pool(threads) {
+        size_t n = m_positions.size();
+        // static candidate adjacency (incoming edges of every node, sorted by sender), built in two passes
+        // over the grid: degrees first, then every node fills its own slice of the preallocated edge arrays
+        spatial::grid_index<dim> index(range);
+        index.build(n, [&](size_t i) -> point_type const& { return m_positions[i]; });
+        m_offset.assign(n + 1, 0);
+        m_pool.run(n, [&](size_t i){
+            size_t degree = 0;
+            index.for_each_candidate(i, [&](size_t j){
+                degree += j != i and length(i, j) <= range;
+            });
+            m_offset[i + 1] = degree;
+        });
+        for (size_t i = 0; i < n; ++i) m_offset[i + 1] += m_offset[i];
+        size_t m = m_offset[n];
+        m_source.resize(m);
+        m_length.resize(m);
+        m_pool.run(n, [&](size_t i){
+            size_t e = m_offset[i];
+            index.for_each_candidate(i, [&](size_t j){
+                if (j != i and length(i, j) <= range) m_source[e++] = (uint32_t)j;
+            });
+            std::sort(m_source.begin() + m_offset[i], m_source.begin() + m_offset[i + 1]);
+            for (e = m_offset[i]; e < m_offset[i + 1]; ++e) m_length[e] = length(i, m_source[e]);
+        });
+        // reverse edges (the edge from i to j, for the edge from j to i)
+        m_reverse.resize(m);
+        m_pool.run(n, [&](size_t i){
+            for (size_t e = m_offset[i]; e < m_offset[i + 1]; ++e) {
+                size_t j = m_source[e];
+                auto it = std::lower_bound(m_source.begin() + m_offset[j], m_source.begin() + m_offset[j + 1], (uint32_t)i);
+                m_reverse[e] = it - m_source.begin();
+            }
+        });
+        // edge values (the inbox is empty until the first delivery)
+        m_sent.assign(m, 0);
+        m_delivered.assign(m, 0);
+        m_held.assign(m, 0);
+        m_in_distance.assign(m, INF);
+        m_distance_key.assign(m, none);
+        m_in_sp_value.assign(m, 0);
+        m_in_sp_parent.assign(m, 0);
+        m_in_bi.assign(m, 0);
+        m_in_mixed.assign(m, 0);
+        m_uni.assign(m, 0);
+        m_bi_rating.assign(m, 0);
+        for (size_t k = 0; k < K; ++k) {
+            m_in_ssp_value[k].assign(m, 0);
+            m_in_ssp_parent[k].assign(m, 0);
+        }
+        // node values
+        for (size_t b = 0; b < 2; ++b) {
+            m_bi[b].assign(m, 0);
+            m_mixed[b].assign(m, 0);
+            m_distance[b].assign(n, INF);
+            m_sp_value[b].assign(n, 0);
+            m_sp_parent[b].resize(n);
+            for (size_t k = 0; k < K; ++k) {
+                m_ssp_value[k][b].assign(n, 0);
+                m_ssp_rating[k][b].assign(n, 0);
+                m_ssp_parent[k][b].resize(n);
+            }
+        }
+        m_root.assign(n, 0);
+        m_key.resize(n);
+        m_transition.assign(n, 0);
+        // initial node values, in a single pass over the nodes
+        m_pool.run(n, [&](size_t i){
+            for (size_t b = 0; b < 2; ++b) {
+                m_sp_parent[b][i] = (uint32_t)i;
+                for (size_t k = 0; k < K; ++k) m_ssp_parent[k][b][i] = (uint32_t)i;
+            }
+            m_key[i] = node_random::key(seeds[i]);
+            if (source(i)) m_level[i] = battery::max_level;
+            else m_transition[i] = m_model.next_transition(0, node_random::uniform(m_key[i], 1, 2));
+        });
+    }
+
+    //! @brief Number of nodes.
+    size_t size() const {
+        return m_positions.size();
+    }
+
+    //! @brief Number of candidate edges.
+    size_t edges() const {
+        return m_source.size();
+    }
+
+    //! @brief Number of rounds executed.
+    size_t rounds() const {
+        return m_round;
+    }
+
+    //! @brief Number of gateways.
+    size_t gateway_num() const {
+        return m_gateway_num;
+    }
+
+    //! @brief The position of a node.
+    point_type const& position(size_t i) const {
+        return m_positions[i];
+    }
+
+    //! @brief Whether a node is a gateway.
+    bool source(size_t i) const {
+        return i < m_gateway_num;
+    }
+
+    //! @brief The radio profile of a node.
+    battery::profile const& profile(size_t i) const {
+        return source(i) ? battery::source_profile() : battery::profiles()[m_level[i]];
+    }
+
+    //! @brief The counters of a node after the last round (sp_collection, then ssp_collection for every rating).
+    std::array<real_t, K+1> node_counters(size_t i) const {
+        size_t c = m_round & 1;
+        return {(real_t)m_sp_value[c][i], (real_t)m_ssp_value[0][c][i], (real_t)m_ssp_value[1][c][i], (real_t)m_ssp_value[2][c][i]};
+    }
+
+    //! @brief The source counters after the last round, summed over the gateways (classic, uniconn, biconn, mixed).
+    std::array<real_t, K+1> source_counters() const {
+        std::array<real_t, K+1> s = {0, 0, 0, 0};
+        for (size_t i = 0; i < m_gateway_num; ++i) {
+            std::array<real_t, K+1> c = node_counters(i);
+            // sp_collection collects a gateway into a neighbour gateway with lower identifier
+            if (not m_root[i]) c[0] = 0;
+            for (size_t k = 0; k <= K; ++k) s[k] += c[k];
+        }
+        return s;
+    }
+
+    //! @brief Number of links delivered in the last round.
+    size_t links() const {
+        size_t l = 0;
+        for (uint8_t d : m_delivered) l += d;
+        return l;
+    }
+
+    //! @brief Number of messages used in the last round (delivered or retained).
+    size_t retained() const {
+        size_t l = 0;
+        for (uint8_t h : m_held) l += h;
+        return l;
+    }
+
+    /**
+     * @brief Executes a round of all nodes.
+     *
+     * @param link Predicate `link(round, j, i)` telling whether the message of sender j reaches node i in the round.
+     * @param update Function `update(i, profile)` called when the radio profile of node i changes (and for every node after the first round).
+     */
+    template <typename L, typename U>
+    void round(L&& link, U&& update) {
+        ++m_round;
+        size_t p = (m_round - 1) & 1, c = m_round & 1;
+        // deliveries of the round (none in the first one, when no messages have been sent yet) and the aggregate program
+        m_pool.run(size(), [&](size_t i){
+            for (size_t e = m_offset[i]; e < m_offset[i + 1]; ++e) {
+                m_delivered[e] = m_round > 1 and link(m_round, m_source[e], i);
+                if (m_delivered[e]) deliver(e, p);
+                m_held[e] = m_sent[e] > 0 and m_round - m_sent[e] <= m_window;
+                m_distance_key[e] = m_held[e] ? key(m_in_distance[e]) : none;
+            }
+            program(i, p, c);
+        });
+        // battery transitions, whose profiles affect the links of the next round
+        m_pool.run(size(), [&](size_t i){
+            bool changed = m_round == 1;
+            if (not source(i) and (int)m_round == m_transition[i]) {
+                int level = m_model.transition(m_level[i], node_random::uniform(m_key[i], m_round, 0));
+                changed |= level != m_level[i];
+                m_level[i] = level;
+                m_transition[i] = m_model.next_transition(m_round, node_random::uniform(m_key[i], m_round, 1));
+            }
+            if (changed) update(i, profile(i));
+        });
+    }
+
+    //! @brief Executes a round of all nodes, ignoring profile changes.
+    template <typename L>
+    void round(L&& link) {
+        round(link, [](size_t, battery::profile const&){});
+    }
+
+  private:
+    //! @brief Euclidean distance between two nodes.
+    double length(size_t i, size_t j) const {
+        double s = 0;
+        for (size_t d = 0; d < dim; ++d) s += (m_positions[i][d] - m_positions[j][d]) * (m_positions[i][d] - m_positions[j][d]);
+        return std::sqrt(s);
+    }
+
+    //! @brief Copies to edge e the message sent by its sender in the previous round (buffer p).
+    void deliver(size_t e, size_t p) {
+        uint32_t j = m_source[e];
+        m_sent[e] = m_round - 1;
+        m_in_distance[e] = m_distance[p][j];
+        m_in_sp_value[e] = m_sp_value[p][j];
+        m_in_sp_parent[e] = m_sp_parent[p][j];
+        m_in_bi[e] = m_bi[p][m_reverse[e]];
+        m_in_mixed[e] = m_mixed[p][m_reverse[e]];
+        for (size_t k = 0; k < K; ++k) {
+            m_in_ssp_value[k][e] = m_ssp_value[k][p][j];
+            m_in_ssp_parent[k][e] = m_ssp_parent[k][p][j];
+        }
+    }
+
+    //! @brief Unsigned integer type with the width of a real.
+    using key_type = std::conditional_t<sizeof(real_t) == sizeof(uint64_t), uint64_t, uint32_t>;
+
+    //! @brief Key of an edge without a message used, greater than the key of any real.
+    static constexpr key_type none = std::numeric_limits<key_type>::max();
+
+    //! @brief The bits of a non-negative real, as an integer key with the same ordering.
+    static key_type key(real_t x) {
+        return __builtin_bit_cast(key_type, x);
+    }
+
+    //! @brief The non-negative real with the given key.
+    static real_t unkey(key_type k) {
+        return __builtin_bit_cast(real_t, k);
+    }
+
+    //! @brief All ones if b holds, zero otherwise.
+    template <typename T>
+    static T mask(bool b) {
+        return T(0) - T(b);
+    }
+
+    //! @brief Updates the connection ratings of edges lo to hi (the arrays are distinct, so that the loop vectorises).
+    static void rate(size_t lo, size_t hi, uint8_t const* __restrict held, real_t const* __restrict in_bi, real_t const* __restrict in_mixed, real_t const* __restrict mixed_old,
+                     real_t* __restrict uni, real_t* __restrict bi_rating, real_t* __restrict bi, real_t* __restrict mixed) {
+        for (size_t e = lo; e < hi; ++e) {
+            real_t h = held[e], o = mixed_old[e], r = in_bi[e] + 1;
+            uni[e] += h;
+            bi_rating[e] = r;
+            bi[e] = h * r;
+            mixed[e] = h > 0 ? (o == 0 ? in_mixed[e] / 2 : o) + 1 : o;
+        }
+    }
+
+    /**
+     * @brief The round of node i, reading buffer p and writing buffer c.
+     *
+     * Every neighbour reduction is a branch-free loop over plain edge arrays, where edges without a
+     * message used are masked by selects. Distances and ratings are never negative, so that they are
+     * compared through the integer keys of their bits; lexicographic minima (by distance, then rating,
+     * then identifier) are computed one component per loop, and the collected counts are integers.
+     */
+    void program(size_t i, size_t p, size_t c) {
+        size_t lo = m_offset[i], hi = m_offset[i + 1];
+        uint8_t const* held = m_held.data();
+        uint32_t const* src = m_source.data();
+        key_type const* dist = m_distance_key.data();
+        uint32_t const self = (uint32_t)i;
+
+        // abf_distance
+        real_t const* in_distance = m_in_distance.data();
+        double const* length = m_length.data();
+        key_type dk = key(INF);
+        for (size_t e = lo; e < hi; ++e)
+            dk = std::min(dk, key(in_distance[e] + (real_t)length[e]) | mask<key_type>(not held[e]));
+        real_t d = source(i) ? 0 : unkey(dk);
+        m_distance[c][i] = d;
+
+        // connection ratings (per edge): entries of fields kept through old survive while their neighbour is not heard,
+        // while fields exported through nbr only hold the neighbours heard
+        rate(lo, hi, held, m_in_bi.data(), m_in_mixed.data(), m_mixed[p].data(), m_uni.data(), m_bi_rating.data(), m_bi[c].data(), m_mixed[c].data());
+
+        // the least distance among the node and the neighbours used (shared by sp_collection and ssp_collection)
+        key_type const self_key = key(d);
+        key_type best = self_key;
+        for (size_t e = lo; e < hi; ++e) best = std::min(best, dist[e]);
+
+        // sp_collection (a gateway is collected into a neighbour gateway with lower identifier)
+        uint32_t sp_parent = self | mask<uint32_t>(best != self_key);
+        for (size_t e = lo; e < hi; ++e) sp_parent = std::min(sp_parent, src[e] | mask<uint32_t>(dist[e] != best));
+        uint32_t const* in_sp_parent = m_in_sp_parent.data();
+        uint32_t const* in_sp_value = m_in_sp_value.data();
+        uint32_t value = 1;
+        for (size_t e = lo; e < hi; ++e) value += (held[e] & (in_sp_parent[e] == self)) ? in_sp_value[e] : 0;
+        uint32_t const lower = std::min<uint32_t>(self, m_gateway_num);
+        uint8_t lower_source = 0;
+        for (size_t e = lo; e < hi; ++e) lower_source |= held[e] & (src[e] < lower);
+        m_sp_parent[c][i] = sp_parent;
+        m_sp_value[c][i] = value;
+        m_root[i] = source(i) and not lower_source;
+
+        // ssp_collection, in separate passes over contiguous edge arrays for every rating
+        real_t const* ratings[K] = {m_uni.data(), m_bi_rating.data(), m_in_mixed.data()};
+        for (size_t k = 0; k < K; ++k) {
+            real_t const* rating = ratings[k];
+            uint32_t const* in_value = m_in_ssp_value[k].data();
+            uint32_t const* in_parent = m_in_ssp_parent[k].data();
+            // the greatest rating at the least distance (the rating of the node itself is zero, the least key)
+            key_type rating_best = 0;
+            for (size_t e = lo; e < hi; ++e) rating_best = std::max(rating_best, key(rating[e]) & ~mask<key_type>(dist[e] != best));
+            // the least identifier with both
+            uint32_t best_parent = self | mask<uint32_t>(best != self_key or rating_best != 0);
+            for (size_t e = lo; e < hi; ++e)
+                best_parent = std::min(best_parent, src[e] | mask<uint32_t>((dist[e] != best) | (key(rating[e]) != rating_best)));
+            uint32_t folded = 1;
+            for (size_t e = lo; e < hi; ++e) folded += (held[e] & (in_parent[e] == self)) ? in_value[e] : 0;
+            real_t best_rating = unkey(rating_best);
+            real_t rating_evolved = m_ssp_rating[k][p][i] * m_stale_factor;
+            uint32_t parent = m_ssp_parent[k][p][i];
+            m_ssp_value[k][c][i] = folded;
+            if (d == 0) {
+                // sources are roots, so that no source is collected into another
+                m_ssp_rating[k][c][i] = 0;
+                m_ssp_parent[k][c][i] = self;
+            } else if (best_parent != parent and best_rating < rating_evolved) {
+                m_ssp_rating[k][c][i] = rating_evolved;
+                m_ssp_parent[k][c][i] = parent;
+            } else {
+                m_ssp_rating[k][c][i] = best_rating;
+                m_ssp_parent[k][c][i] = best_parent;
+            }
+        }
+    }
+
+    //! @brief Node positions.
+    std::vector<point_type> m_positions;
+    //! @brief Start of the incoming edges of every node (CSR layout).
+    std::vector<size_t> m_offset;
+    //! @brief Sender of every edge.
+    std::vector<uint32_t> m_source;
+    //! @brief Length of every edge.
+    std::vector<double> m_length;
+    //! @brief Reverse of every edge.
+    std::vector<size_t> m_reverse;
+    //! @brief The round in which the message held by every edge was sent (zero if none).
+    std::vector<uint32_t> m_sent;
+    //! @brief Whether every edge delivered a message in the last round.
+    std::vector<uint8_t> m_delivered;
+    //! @brief Whether the message held by every edge was used in the last round.
+    std::vector<uint8_t> m_held;
+    //! @brief The abf_distance of the message held by every edge.
+    std::vector<real_t> m_in_distance;
+    //! @brief The key of the abf_distance of the message held by every edge (none if the edge holds no message used).
+    std::vector<key_type> m_distance_key;
+    //! @brief The sp_collection value of the message held by every edge.
+    std::vector<uint32_t> m_in_sp_value;
+    //! @brief The sp_collection parent of the message held by every edge.
+    std::vector<uint32_t> m_in_sp_parent;
+    //! @brief The ssp_collection values of the message held by every edge, by rating.
+    std::array<std::vector<uint32_t>, K> m_in_ssp_value;
+    //! @brief The ssp_collection parents of the message held by every edge, by rating.
+    std::array<std::vector<uint32_t>, K> m_in_ssp_parent;
+    //! @brief The bi_connection value for the receiver in the message held by every edge.
+    std::vector<real_t> m_in_bi;
+    //! @brief The mixed_connection value for the receiver in the message held by every edge.
+    std::vector<real_t> m_in_mixed;
+    //! @brief The uni_connection rating of every edge.
+    std::vector<real_t> m_uni;
+    //! @brief The bi_connection rating of every edge in the last round.
+    std::vector<real_t> m_bi_rating;
+    //! @brief The bi_connection field exported on every edge (double-buffered).
+    std::array<std::vector<real_t>, 2> m_bi;
+    //! @brief The mixed_connection field stored and exported on every edge (double-buffered).
+    std::array<std::vector<real_t>, 2> m_mixed;
+    //! @brief The abf_distance of every node (double-buffered).
+    std::array<std::vector<real_t>, 2> m_distance;
+    //! @brief The sp_collection value of every node (double-buffered).
+    std::array<std::vector<uint32_t>, 2> m_sp_value;
+    //! @brief The sp_collection parent of every node (double-buffered).
+    std::array<std::vector<uint32_t>, 2> m_sp_parent;
+    //! @brief The ssp_collection values of every node, by rating (double-buffered).
+    std::array<std::array<std::vector<uint32_t>, 2>, K> m_ssp_value;
+    //! @brief The ssp_collection ratings of every node, by rating (double-buffered).
+    std::array<std::array<std::vector<real_t>, 2>, K> m_ssp_rating;
+    //! @brief The ssp_collection parents of every node, by rating (double-buffered).
+    std::array<std::array<std::vector<uint32_t>, 2>, K> m_ssp_parent;
+    //! @brief Whether every gateway is the root of its sp_collection tree in the last round.
+    std::vector<uint8_t> m_root;
+    //! @brief The battery level of every node.
+    std::vector<int> m_level;
+    //! @brief The round of the next battery transition of every node.
+    std::vector<int> m_transition;
+    //! @brief The random stream key of every node.
+    std::vector<uint64_t> m_key;
+    //! @brief The stale factor of ssp_collection.
+    real_t m_stale_factor;
+    //! @brief The battery model.
+    battery::geometric m_model;
+    //! @brief The number of gateways.
+    size_t m_gateway_num;
+    //! @brief The number of rounds for which a message is used after the round it was sent in.
+    size_t m_window;
+    //! @brief The threads sweeping over nodes.
+    worker_pool m_pool;
+    //! @brief The number of rounds executed.
+    size_t m_round = 0;
+};
+
+} // namespace soa
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_SOA_ENGINE_H_
@@ -0,0 +1,217 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file stream-stats.hpp
+ * @brief Online cross-run statistics of logged values, with memory independent of the number of runs.
+ *
+ * For every time bucket and logged column, values are accumulated into a Welford mean/variance
+ * estimator and a mergeable quantile sketch with bounded relative error. Accumulators of different
+ * runs or batch shards can be merged at any time.
+ */
+
+#ifndef CASE_STUDY_STREAM_STATS_H_
+#define CASE_STUDY_STREAM_STATS_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "lib/fcpp.hpp"
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for streaming statistics.
+namespace stats {
+
+//! @brief Online mean and variance estimator (Welford), mergeable (Chan et al.).
+class welford {
+  public:
+    //! @brief Adds a value.
+    void add(double x) {
+        ++m_count;
+        double d = x - m_mean;
+        m_mean += d / m_count;
+        m_m2 += d * (x - m_mean);
+    }
+
+    //! @brief Merges another estimator into this one.
+    welford& operator+=(welford const& o) {
+        if (o.m_count == 0) return *this;
+        uint64_t n = m_count + o.m_count;
+        double d = o.m_mean - m_mean;
+        m_mean += d * o.m_count / n;
+        m_m2 += o.m_m2 + d * d * m_count * o.m_count / n;
+        m_count = n;
+        return *this;
+    }
+
+    //! @brief Number of values.
+    uint64_t count() const {
+        return m_count;
+    }
+
+    //! @brief Mean of the values.
+    double mean() const {
+        return m_mean;
+    }
+
+    //! @brief Sample variance of the values.
+    double variance() const {
+        return m_count > 1 ? m_m2 / (m_count - 1) : 0;
+    }
+
+  private:
+    //! @brief Number of values.
+    uint64_t m_count = 0;
+    //! @brief Mean of the values.
+    double m_mean = 0;
+    //! @brief Sum of squared deviations from the mean.
+    double m_m2 = 0;
+};
+
+/**
+ * @brief Mergeable quantile sketch with relative accuracy (logarithmic buckets, as in DDSketch).
+ *
+ * Every quantile estimate is within a relative error `alpha` of a value of the right rank. Memory
+ * grows with the logarithm of the range of the values, not with their number.
+ */
+class quantile_sketch {
+  public:
+    //! @brief Constructor given the relative accuracy.
+    explicit quantile_sketch(double alpha = 0.01) : m_gamma((1 + alpha) / (1 - alpha)), m_log_gamma(std::log(m_gamma)) {}
+
+    //! @brief Adds a value.
+    void add(double x) {
+        if (x > 0) ++m_pos[key(x)];
+        else if (x < 0) ++m_neg[key(-x)];
+        else ++m_zero;
+        ++m_count;
+    }
+
+    //! @brief Merges another sketch (with the same accuracy) into this one.
+    quantile_sketch& operator+=(quantile_sketch const& o) {
+        for (auto const& b : o.m_pos) m_pos[b.first] += b.second;
+        for (auto const& b : o.m_neg) m_neg[b.first] += b.second;
+        m_zero += o.m_zero;
+        m_count += o.m_count;
+        return *this;
+    }
+
+    //! @brief Estimate of the q-quantile (q in [0,1]).
+    double quantile(double q) const {
+        if (m_count == 0) return std::nan("");
+        uint64_t rank = (uint64_t)(q * (m_count - 1));
+        uint64_t seen = 0;
+        for (auto b = m_neg.rbegin(); b != m_neg.rend(); ++b)
+            if ((seen += b->second) > rank) return -value(b->first);
+        if ((seen += m_zero) > rank) return 0;
+        for (auto const& b : m_pos)
+            if ((seen += b.second) > rank) return value(b.first);
+        return value(m_pos.rbegin()->first);
+    }
+
+  private:
+    //! @brief Bucket of a positive value.
+    int key(double x) const {
+        return (int)std::ceil(std::log(x) / m_log_gamma);
+    }
+
+    //! @brief Representative value of a bucket.
+    double value(int k) const {
+        return 2 * std::pow(m_gamma, k) / (m_gamma + 1);
+    }
+
+    //! @brief Ratio between consecutive bucket bounds.
+    double m_gamma;
+    //! @brief Logarithm of m_gamma.
+    double m_log_gamma;
+    //! @brief Counts of positive values by bucket.
+    std::map<int, uint64_t> m_pos;
+    //! @brief Counts of negative values by bucket (of their absolute value).
+    std::map<int, uint64_t> m_neg;
+    //! @brief Count of zero values.
+    uint64_t m_zero = 0;
+    //! @brief Count of all values.
+    uint64_t m_count = 0;
+};
+
+//! @brief Statistics of a single column in a time bucket.
+struct column_stats {
+    //! @brief Mean and variance.
+    welford moments;
+    //! @brief Quantiles.
+    quantile_sketch quantiles;
+
+    //! @brief Adds a value.
+    void add(double x) {
+        moments.add(x);
+        quantiles.add(x);
+    }
+
+    //! @brief Merges other statistics into these.
+    column_stats& operator+=(column_stats const& o) {
+        moments += o.moments;
+        quantiles += o.quantiles;
+        return *this;
+    }
+};
+
+/**
+ * @brief Plotter-like accumulator of cross-run statistics for the given row tags, bucketed by time.
+ *
+ * @param Ss The tags of the logged values to be accumulated.
+ */
+template <typename... Ss>
+class time_stats {
+  public:
+    //! @brief Accumulates a logged row (times are bucketed to the closest integer).
+    template <typename R>
+    time_stats& operator<<(R const& row) {
+        size_t t = (size_t)std::max<long long>(std::llround(common::get<plot::time>(row)), 0);
+        if (t >= m_buckets.size()) m_buckets.resize(t + 1);
+        size_t c = 0;
+        ((m_buckets[t][c++].add(static_cast<double>(common::get<Ss>(row)))), ...);
+        return *this;
+    }
+
+    //! @brief Merges the statistics of other runs into these.
+    time_stats& operator+=(time_stats const& o) {
+        if (o.m_buckets.size() > m_buckets.size()) m_buckets.resize(o.m_buckets.size());
+        for (size_t t = 0; t < o.m_buckets.size(); ++t)
+            for (size_t c = 0; c < sizeof...(Ss); ++c)
+                m_buckets[t][c] += o.m_buckets[t][c];
+        return *this;
+    }
+
+    //! @brief Writes the current statistics in CSV format (a row for every time bucket and column).
+    void flush(std::ostream& o) const {
+        std::vector<std::string> names = {common::type_name<Ss>()...};
+        o << "time,column,count,mean,stddev,p05,p25,p50,p75,p95\n";
+        for (size_t t = 0; t < m_buckets.size(); ++t)
+            for (size_t c = 0; c < sizeof...(Ss); ++c) {
+                column_stats const& s = m_buckets[t][c];
+                if (s.moments.count() == 0) continue;
+                o << t << ",\"" << names[c] << "\"," << s.moments.count() << "," << s.moments.mean() << "," << std::sqrt(s.moments.variance());
+                for (double q : {0.05, 0.25, 0.5, 0.75, 0.95}) o << "," << s.quantiles.quantile(q);
+                o << "\n";
+            }
+    }
+
+  private:
+    //! @brief The statistics for every time bucket and column.
+    std::vector<std::array<column_stats, sizeof...(Ss)>> m_buckets;
+};
+
+} // namespace stats
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_STREAM_STATS_H_
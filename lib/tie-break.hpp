@@ -0,0 +1,93 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file tie-break.hpp
+ * @brief Round schedules in which no two nodes ever share a round time, ordering rounds by (time, uid).
+ *
+ * The times of a schedule are rounded up to a tick, and the identifier of the node is written in the
+ * bits below the tick. Two rounds of different nodes then never happen at the same time, nor at the
+ * time of a log (a multiple of the tick), so that the order of all events is fixed by their times.
+ */
+
+#ifndef CASE_STUDY_TIE_BREAK_H_
+#define CASE_STUDY_TIE_BREAK_H_
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "lib/fcpp.hpp"
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for schedules with a deterministic order of simultaneous rounds.
+namespace tie_break {
+
+//! @brief Ticks per second to which round times are rounded up.
+constexpr double ticks = 1 << 10;
+
+//! @brief Number of identifiers that can be written below a tick (greater identifiers are rejected).
+constexpr double slots = 1 << 20;
+
+//! @brief Times from which rounding would lose the identifier (left unchanged, as TIME_MAX).
+constexpr double limit = (1ULL << 52) / (ticks * slots);
+
+static_assert(std::is_same<times_t, double>::value, "tie_break needs times_t to be double");
+
+//! @brief The time t rounded up to a tick, plus the identifier of a node (shifted by one) below the tick.
+inline times_t snap(times_t t, device_t uid) {
+    if (not (t < limit)) return t;
+    return (std::ceil(t * ticks) * slots + uid + 1) / (ticks * slots);
+}
+
+//! @brief A sequence S with times snapped by the identifier of the node.
+template <typename S>
+class sequence {
+  public:
+    //! @brief Constructor from the node initialisation values (including the identifier).
+    template <typename G, typename U, typename T>
+    sequence(G&& g, common::tagged_tuple<U,T> const& t) : m_sequence(std::forward<G>(g), t), m_uid(common::get<component::tags::uid>(t)) {
+        if (m_uid + 1 >= slots) throw std::out_of_range("tie_break: node " + std::to_string(m_uid) + " beyond the identifiers below a tick");
+    }
+
+    //! @brief Check whether the sequence is finished.
+    bool empty() const {
+        return m_sequence.empty();
+    }
+
+    //! @brief Returns the next event, without stepping over.
+    times_t next() const {
+        return snap(m_sequence.next(), m_uid);
+    }
+
+    //! @brief Steps over to the next event, without returning.
+    template <typename G>
+    void step(G&& g) {
+        m_sequence.step(std::forward<G>(g));
+    }
+
+    //! @brief Returns the next event, stepping over.
+    template <typename G>
+    times_t operator()(G&& g) {
+        times_t t = next();
+        step(std::forward<G>(g));
+        return t;
+    }
+
+  private:
+    //! @brief The sequence being snapped.
+    S m_sequence;
+    //! @brief The identifier of the node.
+    device_t m_uid;
+};
+
+} // namespace tie_break
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_TIE_BREAK_H_
@@ -0,0 +1,314 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file trace.hpp
+ * @brief Recording of connectivity traces and replay of aggregate programs on them.
+ *
+ * A trace lists every round of every node: its time, the power and sleep ratios of the node, and for
+ * every neighbour message available in the round the sender, the round of the sender that produced it
+ * and the distance to the sender. Together with the results computed by the node, this is enough to
+ * re-execute aggregate programs on exactly the same network history, without simulating mobility,
+ * scheduling or connections.
+ */
+
+#ifndef CASE_STUDY_TRACE_H_
+#define CASE_STUDY_TRACE_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lib/fcpp.hpp"
+#include "lib/mapped-file.hpp"
+#include "lib/retention.hpp"
+
+#ifndef AP_TRACE
+#define AP_TRACE 0
+#endif
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for connectivity traces.
+namespace trace {
+
+//! @brief Magic string at the start of a trace file.
+constexpr char magic[8] = {'A', 'P', 'T', 'R', 'C', 'v', '1', '\0'};
+
+//! @brief A message available to a node in a round.
+struct heard {
+    //! @brief The sender.
+    device_t uid;
+    //! @brief The round of the sender that produced the message.
+    uint32_t round;
+    //! @brief The distance to the sender.
+    float distance;
+};
+
+//! @brief A round of a node.
+struct round_record {
+    //! @brief Time of the round.
+    double time;
+    //! @brief The node executing the round.
+    device_t uid;
+    //! @brief The round number of the node (starting from 1).
+    uint32_t round;
+    //! @brief The sleep ratio of the node in the round.
+    float sleep_ratio;
+    //! @brief The send power ratio of the node in the round.
+    float send_power_ratio;
+    //! @brief The receive power ratio of the node in the round.
+    float recv_power_ratio;
+    //! @brief The values computed by the node in the round (for validation of replays).
+    std::array<float, 4> results;
+    //! @brief The messages available in the round, sorted by sender.
+    std::vector<heard> messages;
+};
+
+//! @brief Writes round records to a trace file (neighbour lists are delta and varint encoded).
+class recorder {
+  public:
+    //! @brief Creates (or truncates) the trace file at the given path.
+    explicit recorder(std::string const& path) : m_file(std::fopen(path.c_str(), "wb")) {
+        if (m_file == nullptr) throw std::runtime_error("cannot open " + path);
+        std::fwrite(magic, 1, sizeof(magic), m_file);
+    }
+
+    recorder(recorder const&) = delete;
+    recorder& operator=(recorder const&) = delete;
+
+    ~recorder() {
+        std::fclose(m_file);
+    }
+
+    //! @brief Appends a round record.
+    void record(round_record r) {
+        std::sort(r.messages.begin(), r.messages.end(), [](heard const& a, heard const& b){
+            return a.uid < b.uid;
+        });
+        m_buffer.clear();
+        put(r.time);
+        varint(r.uid);
+        varint(r.round);
+        put(r.sleep_ratio);
+        put(r.send_power_ratio);
+        put(r.recv_power_ratio);
+        put(r.results);
+        varint(r.messages.size());
+        device_t last = 0;
+        for (heard const& h : r.messages) {
+            varint(h.uid - last);
+            varint(h.round);
+            put(h.distance);
+            last = h.uid;
+        }
+        std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+    }
+
+    //! @brief The recorder active in the current thread (null if not recording), which also runs every round when AP_PARALLEL=0.
+    static recorder*& active() {
+        thread_local recorder* r = nullptr;
+        return r;
+    }
+
+  private:
+    //! @brief Appends a fixed-size value.
+    template <typename T>
+    void put(T const& x) {
+        char const* p = reinterpret_cast<char const*>(&x);
+        m_buffer.insert(m_buffer.end(), p, p + sizeof(T));
+    }
+
+    //! @brief Appends an unsigned number in LEB128 format.
+    void varint(uint64_t x) {
+        do {
+            uint8_t b = x & 0x7F;
+            x >>= 7;
+            if (x) b |= 0x80;
+            m_buffer.push_back(b);
+        } while (x);
+    }
+
+    //! @brief The trace file.
+    std::FILE* m_file;
+    //! @brief The encoding of the current record.
+    std::vector<char> m_buffer;
+};
+
+//! @brief Reads round records from a memory-mapped trace file, in order.
+class reader {
+  public:
+    //! @brief Opens the trace file at the given path.
+    explicit reader(std::string const& path) : m_file(path, true) {
+        if (m_file.size() < sizeof(magic) or std::memcmp(m_file.data(), magic, sizeof(magic)) != 0)
+            throw std::runtime_error("invalid trace file " + path);
+        m_pos = sizeof(magic);
+    }
+
+    //! @brief Reads the next record, returning false at the end of the trace.
+    bool next(round_record& r) {
+        if (m_pos >= m_file.size()) return false;
+        get(r.time);
+        r.uid = (device_t)varint();
+        r.round = (uint32_t)varint();
+        get(r.sleep_ratio);
+        get(r.send_power_ratio);
+        get(r.recv_power_ratio);
+        get(r.results);
+        r.messages.resize(varint());
+        device_t last = 0;
+        for (heard& h : r.messages) {
+            h.uid = last + (device_t)varint();
+            h.round = (uint32_t)varint();
+            get(h.distance);
+            last = h.uid;
+        }
+        return true;
+    }
+
+  private:
+    //! @brief Reads a fixed-size value.
+    template <typename T>
+    void get(T& x) {
+        if (m_pos + sizeof(T) > m_file.size()) throw std::runtime_error("truncated trace");
+        std::memcpy(&x, m_file.data() + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+    }
+
+    //! @brief Reads an unsigned number in LEB128 format.
+    uint64_t varint() {
+        uint64_t x = 0;
+        int shift = 0;
+        uint8_t b;
+        do {
+            if (m_pos >= m_file.size()) throw std::runtime_error("truncated trace");
+            b = m_file.data()[m_pos++];
+            x |= uint64_t(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        return x;
+    }
+
+    //! @brief The mapped trace file.
+    mapped_file m_file;
+    //! @brief The current reading position.
+    size_t m_pos = 0;
+};
+
+//! @brief Retention telemetry of a replay.
+struct replay_report {
+    //! @brief Number of rounds replayed.
+    size_t rounds = 0;
+    //! @brief Number of messages evicted, over all nodes.
+    size_t evictions = 0;
+    //! @brief Number of messages available to programs, over all rounds.
+    size_t retained = 0;
+    //! @brief Maximum number of messages held by a node.
+    size_t peak_retained = 0;
+    //! @brief Maximum number of bytes of the retention store of a node (slots, index and payload of the messages held).
+    size_t peak_bytes = 0;
+};
+
+/**
+ * @brief Replays a trace with bounded message retention, executing a program on every round record.
+ *
+ * The program type `P` has to provide a `message_type` and a `state_type`, and a member function
+ * `message_type round(round_record const&, state_type&, std::vector<std::pair<device_t, message_type const*>> const&)`
+ * computing the message of a node given its round, its state and the messages available to it. These
+ * are the messages produced by the senders in the rounds listed by the record, among those kept by
+ * the retention store of the node. Messages produced since the previous round of the node are offered
+ * to the store as they arrive, while older ones are only available if the store still holds them. The
+ * memory of the store counts the payload of the messages it holds, given by a member function
+ * `size_t bytes(message_type const&) const`. Rating-based eviction policies also require a member function
+ * `real_t rating(state_type const&, device_t) const`.
+ *
+ * @param in The trace reader.
+ * @param program The program to execute.
+ * @param history The number of past messages kept for every sender.
+ * @param capacity The maximum number of messages retained by a node.
+ * @param policy The eviction policy.
+ * @param f A function called after every round with the record and the state of the node.
+ */
+template <typename P, typename Q, typename F>
+replay_report replay(reader& in, P& program, size_t history, size_t capacity, Q policy, F&& f) {
+    using message_type = typename P::message_type;
+    using state_type = typename P::state_type;
+    //! @brief Node data kept by the replay engine.
+    struct node_data {
+        state_type state;
+        std::deque<std::tuple<uint32_t, double, message_type>> messages;
+        retention::store<Q> retained;
+        double last_time = -std::numeric_limits<double>::infinity();
+    };
+    std::unordered_map<device_t, node_data> nodes;
+    std::vector<std::pair<device_t, message_type const*>> inbox;
+    round_record r;
+    replay_report report;
+    while (in.next(r)) {
+        auto n_it = nodes.find(r.uid);
+        if (n_it == nodes.end()) n_it = nodes.emplace(r.uid, node_data{state_type{}, {}, retention::store<Q>(capacity, policy)}).first;
+        node_data& n = n_it->second;
+        // messages no longer available expire, the others are offered to the retention store
+        n.retained.expire([&](device_t uid){
+            return std::binary_search(r.messages.begin(), r.messages.end(), heard{uid, 0, 0}, [](heard const& a, heard const& b){
+                return a.uid < b.uid;
+            });
+        });
+        inbox.clear();
+        for (heard const& h : r.messages) {
+            auto it = nodes.find(h.uid);
+            if (it == nodes.end()) continue;
+            for (auto const& m : it->second.messages) {
+                if (std::get<0>(m) != h.round) continue;
+                bool kept = std::get<1>(m) >= n.last_time ? n.retained.offer(h.uid, h.round, program.bytes(std::get<2>(m)), [&](auto uid){
+                    return program.rating(n.state, uid);
+                }) : n.retained.holds(h.uid, h.round);
+                if (kept) inbox.emplace_back(h.uid, &std::get<2>(m));
+                break;
+            }
+        }
+        message_type m = program.round(r, n.state, inbox);
+        n.messages.emplace_back(r.round, r.time, std::move(m));
+        n.last_time = r.time;
+        if (n.messages.size() > history) n.messages.pop_front();
+        f(r, n.state);
+        ++report.rounds;
+        report.retained += inbox.size();
+        report.peak_retained = std::max(report.peak_retained, n.retained.size());
+        report.peak_bytes = std::max(report.peak_bytes, n.retained.bytes());
+    }
+    for (auto const& n : nodes) report.evictions += n.second.retained.evictions();
+    return report;
+}
+
+/**
+ * @brief Replays a trace with unbounded message retention, executing a program on every round record.
+ *
+ * @param in The trace reader.
+ * @param program The program to execute.
+ * @param history The number of past messages kept for every sender.
+ * @param f A function called after every round with the record and the state of the node.
+ * @return The number of rounds replayed.
+ */
+template <typename P, typename F>
+size_t replay(reader& in, P& program, size_t history, F&& f) {
+    return replay(in, program, history, std::numeric_limits<size_t>::max(), retention::oldest_first{}, f).rounds;
+}
+
+} // namespace trace
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_TRACE_H_
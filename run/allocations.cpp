@@ -0,0 +1,140 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file allocations.cpp
+ * @brief Benchmark of the heap allocations per round of the case study, in steady state.
+ */
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+
+#include "lib/benchmark.hpp"
+#include "lib/case-study.hpp"
+
+using namespace fcpp;
+
+
+//! @brief Number of heap allocations performed by the process.
+std::atomic<size_t> allocation_count{0};
+//! @brief Number of bytes allocated by the process.
+std::atomic<size_t> allocation_bytes{0};
+
+//! @brief Counting replacement of the global allocation function.
+void* operator new(size_t n) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(n, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+//! @brief Counting replacement of the global array allocation function.
+void* operator new[](size_t n) {
+    return operator new(n);
+}
+
+//! @brief Replacement of the global deallocation function.
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+//! @brief Replacement of the global array deallocation function.
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+//! @brief Replacement of the global sized deallocation function.
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+//! @brief Replacement of the global sized array deallocation function.
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+//! @brief Runs a simulation, printing a CSV row with the allocations per round between two times, and returns them.
+double run_point(size_t node_num, real_t area_side, real_t warmup, real_t until) {
+    using namespace coordination::tags;
+    //! @brief The network object type (batch simulator with runtime scenario options).
+    using net_t = component::batch_simulator<option::scenario_list>::net;
+    option::plot_t plotter;
+    auto init_v = common::make_tagged_tuple<option::seed, option::output, option::plotter, scenario_node_num, scenario_area_side, component::tags::radius>(
+        0,
+        &bench::null_stream(),
+        &plotter,
+        node_num,
+        area_side,
+        coordination::configurations::communication_range
+    );
+    net_t network{init_v};
+    auto rounds = [&](){
+        double r = 0;
+        for (device_t uid = 0; uid < network.node_size(); ++uid) r += network.node_at(uid).storage(node_round_count{});
+        return r;
+    };
+    while (network.next() < warmup) network.update();
+    double start_rounds = rounds();
+    size_t start_count = allocation_count, start_bytes = allocation_bytes;
+    while (network.next() < until) network.update();
+    size_t count = allocation_count - start_count, bytes = allocation_bytes - start_bytes;
+    double steady_rounds = rounds() - start_rounds;
+    std::cout << node_num << "," << steady_rounds << "," << count << "," << count / steady_rounds << "," << bytes / steady_rounds << std::endl;
+    return count / steady_rounds;
+}
+
+/**
+ * @brief The main function.
+ *
+ * Arguments (all optional):
+ * - `--nodes`: comma-separated node numbers to test (with the density of the configured scenario);
+ * - `--warmup`: simulated time before counting allocations (50 by default);
+ * - `--until`: simulated time at which counting stops (100 by default);
+ * - `--max`: allocations per node round above which a point fails (no limit by default);
+ * - `--growth`: factor by which the allocations per node round of a point may exceed those of the first point (no limit by default).
+ *
+ * The process exits with status 1 if any point fails.
+ */
+int main(int argc, char** argv) {
+    using namespace coordination::configurations;
+    std::vector<size_t> nodes = bench::parse_list<size_t>(bench::get_arg(argc, argv, "nodes", "100,1000"));
+    real_t warmup = std::stod(bench::get_arg(argc, argv, "warmup", "50"));
+    real_t until = std::stod(bench::get_arg(argc, argv, "until", "100"));
+    std::string max = bench::get_arg(argc, argv, "max", "");
+    std::string growth = bench::get_arg(argc, argv, "growth", "");
+    // the allocations per node round of every point, written by the process running it
+    double* per_round = static_cast<double*>(mmap(nullptr, nodes.size() * sizeof(double), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+    if (per_round == MAP_FAILED) {
+        std::cerr << "cannot share the results of the points" << std::endl;
+        return 1;
+    }
+
+    bool failed = false;
+    std::cout << "node_num,rounds,allocations,allocations_per_round,bytes_per_round" << std::endl;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        size_t n = nodes[i];
+        real_t side = area_side * std::sqrt(n / real_t(node_num));
+        bool ok = bench::run_isolated([&](){
+            per_round[i] = run_point(n, side, warmup, until);
+        });
+        if (not ok) {
+            std::cerr << "run failed: " << n << " nodes" << std::endl;
+        } else if (not max.empty() and per_round[i] > std::stod(max)) {
+            std::cerr << n << " nodes: " << per_round[i] << " allocations per round, above the limit of " << max << std::endl;
+            ok = false;
+        } else if (not growth.empty() and per_round[i] > std::stod(growth) * per_round[0]) {
+            std::cerr << n << " nodes: " << per_round[i] << " allocations per round, more than " << growth << " times the " << per_round[0] << " of " << nodes[0] << " nodes" << std::endl;
+            ok = false;
+        }
+        failed |= not ok;
+    }
+    munmap(per_round, nodes.size() * sizeof(double));
+    return failed;
+}
@@ -9,27 +9,126 @@
 //! Importing the FCPP library.
 #include "lib/fcpp.hpp"
 
+#include <cstdio>
+#include <fstream>
+#include <type_traits>
+
+#include "lib/benchmark.hpp"
 #include "lib/case-study.hpp"
+#include "lib/columnar.hpp"
+#include "lib/parallel-batch.hpp"
 
 using namespace fcpp;
 
 
-//! @brief The main function.
-int main() {
-    //! @brief Construct the plotter object.
-    option::plot_t p;
-    //! @brief The component type (batch simulator with given options).
-    using comp_t = component::batch_simulator<option::list>;
-    //! @brief The list of initialisation values to be used for simulations.
-    auto init_list = batch::make_tagged_tuple_sequence(
-        batch::arithmetic<option::seed>(0, 999, 1),      // 100 different random seeds
-        // generate output file name for the run
-        batch::stringify<option::output>("output/batch", "txt"),
-        batch::constant<option::plotter>(&p) // reference to the plotter object
-    );
-    //! @brief Runs the given simulations.
-    batch::run(comp_t{}, init_list);
+//! @brief The component type (batch simulator with given options).
+using comp_t = component::batch_simulator<option::batch_list>;
+
+//! @brief The results collected by a chunk of runs.
+struct batch_shard {
+    //! @brief The plots (not fed in stats-only batches).
+    option::plot_t plot;
+    //! @brief The cross-run statistics.
+    option::stats_t stats;
+
+    //! @brief Merges the results of other runs.
+    batch_shard& operator+=(batch_shard const& o) {
+        plot += o.plot;
+        stats += o.stats;
+        return *this;
+    }
+};
+
+//! @brief Writes the cross-run statistics, replacing the previous file only once the new one is complete.
+void write_stats(batch_shard const& results) {
+    {
+        std::ofstream stats_file("output/batch-stats.csv.tmp");
+        results.stats.flush(stats_file);
+    }
+    std::rename("output/batch-stats.csv.tmp", "output/batch-stats.csv");
+}
+
+//! @brief Runs a batch, streaming rows to a columnar writer if given, and writing the statistics every `flush` runs (if not zero).
+template <typename S>
+batch::shard_report run_batch(S const& init_list, batch_shard& results, columnar::writer* out, bool plots, size_t threads, size_t chunk, size_t flush) {
+    size_t flushed = 0;
+    auto merged = [&](size_t runs){
+        if (flush == 0 or runs < flushed + flush) return;
+        flushed = runs;
+        write_stats(results);
+    };
+    return batch::sharded_run(comp_t{}, results, init_list, threads, chunk, [out, plots](auto t, batch_shard& shard, size_t){
+#if AP_CHECK_AGGREGATORS
+        option::aggregate_check_t check;
+        option::batch_plot_t sink(out, common::get<option::seed>(t), plots ? &shard.plot : nullptr, &shard.stats, &check);
+#else
+        option::batch_plot_t sink(out, common::get<option::seed>(t), plots ? &shard.plot : nullptr, &shard.stats);
+#endif
+        common::get<option::plotter>(t) = &sink;
+        // in binary format, the comment lines of the text output are kept in the columnar file
+        if constexpr (std::is_same<std::decay_t<decltype(common::get<option::output>(t))>, std::ostream*>::value)
+            if (out != nullptr) common::get<option::output>(t) = sink.output();
+        comp_t::net network{t};
+#if AP_CHECK_AGGREGATORS
+        check.watch(network);
+#endif
+        coordination::run_network(network);
+        // a run stopped at convergence keeps its final values in the plots up to the end (logged every second, as in log_s)
+        sink.carry(coordination::configurations::end, 1);
+    }, merged);
+}
+
+/**
+ * @brief The main function.
+ *
+ * Arguments (all optional):
+ * - `--seeds`: number of runs (1000 by default);
+ * - `--threads`: number of worker threads (the hardware concurrency by default);
+ * - `--chunk`: number of consecutive runs sharing a plotter shard (8 by default);
+ * - `--format`: raw results as a text file per run (`txt`, default) or a single binary columnar file (`bin`);
+ * - `--plots`: whether to build the plots (`yes`, default) or only the cross-run statistics (`no`);
+ * - `--flush`: number of runs after which the cross-run statistics are written again (100 by default, 0 for the end only).
+ */
+int main(int argc, char** argv) {
+    size_t seeds = std::stoul(bench::get_arg(argc, argv, "seeds", "1000"));
+    size_t threads = std::stoul(bench::get_arg(argc, argv, "threads", "0"));
+    size_t chunk = std::stoul(bench::get_arg(argc, argv, "chunk", "8"));
+    bool binary = bench::get_arg(argc, argv, "format", "txt") == "bin";
+    bool plots = bench::get_arg(argc, argv, "plots", "yes") == "yes";
+    size_t flush = std::stoul(bench::get_arg(argc, argv, "flush", "100"));
+    if (seeds == 0) {
+        std::cerr << "--seeds must be at least 1" << std::endl;
+        return 1;
+    }
+    //! @brief Construct the results object.
+    batch_shard results;
+    batch::shard_report report;
+    if (binary) {
+        //! @brief The columnar file receiving the rows of every run.
+        columnar::writer out("output/batch.bin");
+        //! @brief The list of initialisation values to be used for simulations.
+        auto init_list = batch::make_tagged_tuple_sequence(
+            batch::arithmetic<option::seed>(0, seeds-1, 1), // different random seeds
+            batch::constant<option::output>(&bench::null_stream()), // set for each run
+            batch::constant<option::plotter>((option::batch_plot_t*)nullptr) // set for each run
+        );
+        //! @brief Runs the given simulations on a work-stealing thread pool.
+        report = run_batch(init_list, results, &out, plots, threads, chunk, flush);
+    } else {
+        //! @brief The list of initialisation values to be used for simulations.
+        auto init_list = batch::make_tagged_tuple_sequence(
+            batch::arithmetic<option::seed>(0, seeds-1, 1), // different random seeds
+            // generate output file name for the run
+            batch::stringify<option::output>("output/batch", "txt"),
+            batch::constant<option::plotter>((option::batch_plot_t*)nullptr) // set for each run
+        );
+        //! @brief Runs the given simulations on a work-stealing thread pool.
+        report = run_batch(init_list, results, nullptr, plots, threads, chunk, flush);
+    }
+    std::cerr << report;
+    //! @brief Writes the cross-run statistics.
+    write_stats(results);
     //! @brief Builds the resulting plots.
-    std::cout << plot::file("batch", p.build());
+    if (plots) std::cout << plot::file("batch", results.plot.build());
     return 0;
 }
@@ -0,0 +1,30 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file convert.cpp
+ * @brief Converts a binary columnar batch output into text files, one per run.
+ */
+
+#include <fstream>
+#include <iostream>
+
+#include "lib/columnar.hpp"
+
+using namespace fcpp;
+
+
+//! @brief The main function (arguments: columnar file, prefix of the text files to be generated).
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <file.bin> [output prefix]" << std::endl;
+        return 1;
+    }
+    std::string prefix = argc > 2 ? argv[2] : "output/batch";
+    columnar::reader in(argv[1]);
+    for (auto const& run : in.runs()) {
+        std::ofstream out(prefix + "_seed-" + std::to_string((long long)run.first) + ".txt");
+        columnar::to_text(in, run.first, out);
+    }
+    std::cerr << in.rows() << " rows of " << in.runs().size() << " runs converted" << std::endl;
+    return 0;
+}
@@ -0,0 +1,275 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file kernels.cpp
+ * @brief Microbenchmark of the rating kernels and ssp_collection on synthetic neighbourhoods, with baseline comparison.
+ */
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "lib/benchmark.hpp"
+#include "lib/case-study.hpp"
+
+using namespace fcpp;
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace containing the libraries of coordination routines.
+namespace coordination {
+
+//! @brief Tags used in the node storage.
+namespace tags {
+    //! @brief Whether the node is the hub of the neighbourhood (connector data).
+    struct kernel_hub {};
+    //! @brief Number of neighbours of the current node in the last round.
+    struct kernel_neighbours {};
+    //! @brief Nanoseconds spent in the last call to a kernel.
+    template <typename>
+    struct kernel_ns {};
+    //! @brief Number of calls to a kernel.
+    template <typename>
+    struct kernel_calls {};
+    //! @brief Net initialisation tag for the number of nodes.
+    struct kernel_node_num {};
+}
+
+//! @brief Calls a kernel, storing the nanoseconds spent and counting the call in the counters of tag F.
+template <typename F, typename node_t, typename G>
+inline auto timed(node_t& node, G&& f) {
+    auto start = std::chrono::steady_clock::now();
+    auto r = f();
+    node.storage(tags::kernel_ns<F>{}) = std::chrono::duration<real_t, std::nano>(std::chrono::steady_clock::now() - start).count();
+    node.storage(tags::kernel_calls<F>{}) += 1;
+    return r;
+}
+
+//! @brief Namespace of the microbenchmark program.
+namespace kernels {
+    //! @brief Main function: every kernel of the case study, each timed separately.
+    MAIN() {
+        using namespace tags;
+
+        bool hub = node.uid == 0;
+        fcpp::common::get<kernel_hub>(node.connector_data()) = hub;
+        node.storage(kernel_neighbours{}) = count_hood(CALL) - 1;
+
+        auto adder = [](real_t x, real_t y) {
+            return x+y;
+        };
+        real_t distance = coordination::abf_distance(CALL, hub);
+        std::array<field<real_t>, 3> ratings = {
+            timed<uni_connection_fn>(node, [&](){ return uni_connection(CALL); }),
+            timed<bi_connection_fn>(node, [&](){ return bi_connection(CALL); }),
+            timed<mixed_connection_fn>(node, [&](){ return mixed_connection(CALL); })
+        };
+        timed<ssp_collection_fn>(node, [&](){
+            return coordination::ssp_collection(CALL, distance, 1.0, 0, adder, ratings, configurations::parameters().stale_factor);
+        });
+        node.storage(export_bytes<uni_connection_fn>{})   = compact::wire_size(ratings[0]);
+        node.storage(export_bytes<bi_connection_fn>{})    = compact::wire_size(ratings[1]);
+        // mixed_connection stores the bytes of the field it exports, rather than of the one it returns
+    }
+    //! @brief Export types used by the main function.
+    FUN_EXPORT main_t = export_list<any_connection_t, ssp_multi_collection_t<real_t, real_t, real_t, 3>, abf_distance_t>;
+}
+
+} // namespace coordination
+
+namespace option {
+
+//! @brief Connection predicate linking the hub with every other node within communication range, and no other pair.
+struct star_connect : public connect::fixed<coordination::configurations::communication_range, 1, coordination::configurations::dim> {
+    //! @brief The base connection predicate.
+    using base_type = connect::fixed<coordination::configurations::communication_range, 1, coordination::configurations::dim>;
+    //! @brief Whether the node is the hub.
+    using data_type = common::tagged_tuple_t<coordination::tags::kernel_hub, bool>;
+    //! @brief The type of node positions.
+    using position_type = vec<coordination::configurations::dim>;
+
+    using base_type::base_type;
+
+    //! @brief Checks whether connection is possible.
+    template <typename G>
+    bool operator()(G&& gen, data_type const& data1, position_type const& position1, data_type const& data2, position_type const& position2) const {
+        return (common::get<coordination::tags::kernel_hub>(data1) or common::get<coordination::tags::kernel_hub>(data2))
+           and base_type::operator()(gen, {}, position1, {}, position2);
+    }
+};
+
+//! @brief The simulation options of the microbenchmark (kernel_node_num nodes within range of each other, linked as a star).
+DECLARE_OPTIONS(kernel_list,
+    program<coordination::kernels::main>,   // program to be run (refers to MAIN above)
+    exports<coordination::kernels::main_t>, // export type list (types used in messages)
+    retain<metric::retain<2,1>>,            // the last message of every neighbour is kept through the next round
+    round_schedule<sequence::periodic<distribution::interval_n<times_t, 0, 1>, n<1>>>,
+    spawn_schedule<sequence::multiple<i<kernel_node_num, size_t>, distribution::constant_n<times_t, 0>>>,
+    tuple_store<
+        kernel_neighbours,                  real_t,
+        node_parent,                        device_t,
+        node_rating_parent,                 real_t,
+        kernel_ns<uni_connection_fn>,       real_t,
+        kernel_ns<bi_connection_fn>,        real_t,
+        kernel_ns<mixed_connection_fn>,     real_t,
+        kernel_ns<ssp_collection_fn>,       real_t,
+        kernel_calls<uni_connection_fn>,    real_t,
+        kernel_calls<bi_connection_fn>,     real_t,
+        kernel_calls<mixed_connection_fn>,  real_t,
+        kernel_calls<ssp_collection_fn>,    real_t,
+        export_bytes<uni_connection_fn>,    real_t,
+        export_bytes<bi_connection_fn>,     real_t,
+        export_bytes<mixed_connection_fn>,  real_t,
+        export_bytes<ssp_collection_fn>,    real_t
+    >,
+    init<
+        x,                                  distribution::rect_n<1, 0, 0, communication_range/2, communication_range/2>
+    >,
+    dimension<dim>,
+    connector<star_connect>
+);
+
+} // namespace option
+
+} // namespace fcpp
+
+
+//! @brief A measurement of a kernel on a neighbourhood size.
+struct measure {
+    //! @brief Median nanoseconds per call.
+    double median_ns;
+    //! @brief Minimum nanoseconds per call.
+    double min_ns;
+    //! @brief Bytes per export.
+    size_t bytes;
+};
+
+//! @brief Measurements indexed by kernel name and neighbourhood size.
+using measures = std::map<std::pair<std::string, size_t>, measure>;
+
+//! @brief Measures every kernel on the hub of a neighbourhood of the given size, printing a CSV row for each.
+void run_point(size_t neighbours, size_t rounds, measures& m) {
+    using namespace coordination::tags;
+    //! @brief The network object type (batch simulator with the microbenchmark options).
+    using net_t = component::batch_simulator<option::kernel_list>::net;
+    auto init_v = common::make_tagged_tuple<option::seed, option::output, kernel_node_num>(0, &bench::null_stream(), neighbours + 1);
+    net_t network{init_v};
+    // a warm-up of two rounds, so that the hub holds a message from every neighbour
+    while (network.next() < 2) network.update();
+    auto& hub = network.node_at(0);
+    auto reset = [&](auto f){
+        using F = decltype(f);
+        hub.storage(kernel_ns<F>{}) = 0;
+        hub.storage(kernel_calls<F>{}) = 0;
+    };
+    reset(uni_connection_fn{});
+    reset(bi_connection_fn{});
+    reset(mixed_connection_fn{});
+    reset(ssp_collection_fn{});
+    // a sample per call of every kernel (the hub has a round every second)
+    std::array<std::vector<double>, 4> samples;
+    for (size_t r = 1; r <= rounds; ++r) {
+        while (network.next() < 2 + r) network.update();
+        samples[0].push_back(hub.storage(kernel_ns<uni_connection_fn>{}));
+        samples[1].push_back(hub.storage(kernel_ns<bi_connection_fn>{}));
+        samples[2].push_back(hub.storage(kernel_ns<mixed_connection_fn>{}));
+        samples[3].push_back(hub.storage(kernel_ns<ssp_collection_fn>{}));
+    }
+    auto report = [&](auto f, std::string const& name, std::vector<double>& v){
+        using F = decltype(f);
+        std::sort(v.begin(), v.end());
+        measure x{v.empty() ? 0 : v[v.size() / 2], v.empty() ? 0 : v.front(), (size_t)hub.storage(export_bytes<F>{})};
+        m[{name, neighbours}] = x;
+        std::cout << name << "," << neighbours << "," << hub.storage(kernel_neighbours{}) << "," << hub.storage(kernel_calls<F>{}) << ","
+                  << x.median_ns << "," << x.min_ns << "," << x.bytes << std::endl;
+    };
+    report(uni_connection_fn{}, "uni_connection", samples[0]);
+    report(bi_connection_fn{}, "bi_connection", samples[1]);
+    report(mixed_connection_fn{}, "mixed_connection", samples[2]);
+    report(ssp_collection_fn{}, "ssp_collection", samples[3]);
+}
+
+//! @brief Reads measurements from a CSV file written by this benchmark.
+measures read_baseline(std::string const& path) {
+    std::ifstream in(path);
+    if (not in) throw std::runtime_error("cannot open " + path);
+    auto split = [](std::string const& line){
+        std::vector<std::string> cols;
+        std::stringstream ss(line);
+        std::string item;
+        while (std::getline(ss, item, ',')) cols.push_back(item);
+        return cols;
+    };
+    measures m;
+    std::string line;
+    std::getline(in, line);
+    // columns are found by name in the header
+    std::vector<std::string> header = split(line);
+    auto column = [&](std::string const& name){
+        size_t c = std::find(header.begin(), header.end(), name) - header.begin();
+        if (c == header.size()) throw std::runtime_error("no column " + name + " in " + path);
+        return c;
+    };
+    size_t kernel = column("kernel"), neighbours = column("neighbours"), median = column("median_ns"), minimum = column("min_ns"), bytes = column("bytes_per_export");
+    while (std::getline(in, line)) {
+        std::vector<std::string> cols = split(line);
+        if (cols.size() < header.size()) continue;
+        m[{cols[kernel], std::stoul(cols[neighbours])}] = {std::stod(cols[median]), std::stod(cols[minimum]), std::stoul(cols[bytes])};
+    }
+    return m;
+}
+
+/**
+ * @brief The main function.
+ *
+ * Arguments (all optional):
+ * - `--neighbours`: comma-separated neighbourhood sizes to test;
+ * - `--rounds`: number of measured rounds of every neighbourhood, with a call to every kernel each (101 by default);
+ * - `--baseline`: CSV file with the output of a previous run, to compare against;
+ * - `--tolerance`: relative slowdown of the median reported as a regression (0.1 by default);
+ * - `--noise`: slowdown of the median in nanoseconds below which no regression is reported (50 by default).
+ *
+ * With a baseline, the process exits with status 1 if any kernel regressed.
+ */
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes = bench::parse_list<size_t>(bench::get_arg(argc, argv, "neighbours", "1,10,100,1000,10000"));
+    size_t rounds = std::stoul(bench::get_arg(argc, argv, "rounds", "101"));
+    std::string baseline = bench::get_arg(argc, argv, "baseline", "");
+    double tolerance = std::stod(bench::get_arg(argc, argv, "tolerance", "0.1"));
+    double noise = std::stod(bench::get_arg(argc, argv, "noise", "50"));
+
+    measures m;
+    std::cout << "kernel,neighbours,measured_neighbours,calls,median_ns,min_ns,bytes_per_export" << std::endl;
+    for (size_t n : sizes) run_point(n, rounds, m);
+    if (baseline.empty()) return 0;
+
+    // comparison against the baseline: median slowdowns beyond both tolerance and noise, and any change in export size, are regressions
+    size_t regressions = 0;
+    std::cerr << "kernel,neighbours,baseline_median_ns,median_ns,ratio,baseline_min_ns,min_ns,baseline_bytes,bytes" << std::endl;
+    for (auto const& b : read_baseline(baseline)) {
+        auto it = m.find(b.first);
+        if (it == m.end()) continue;
+        double slowdown = it->second.median_ns - b.second.median_ns;
+        double ratio = b.second.median_ns > 0 ? it->second.median_ns / b.second.median_ns : 1;
+        bool regressed = (slowdown > tolerance * b.second.median_ns and slowdown > noise) or it->second.bytes != b.second.bytes;
+        regressions += regressed;
+        std::cerr << b.first.first << "," << b.first.second << "," << b.second.median_ns << "," << it->second.median_ns << "," << ratio << ","
+                  << b.second.min_ns << "," << it->second.min_ns << "," << b.second.bytes << "," << it->second.bytes << (regressed ? ",REGRESSION" : "") << std::endl;
+    }
+    std::cerr << regressions << " regressions against " << baseline << std::endl;
+    return regressions > 0;
+}
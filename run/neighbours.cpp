@@ -0,0 +1,95 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file neighbours.cpp
+ * @brief Scaling benchmark of neighbour discovery with and without the uniform-grid index.
+ */
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+#include "lib/case-study.hpp"
+#include "lib/grid-index.hpp"
+
+using namespace fcpp;
+
+
+//! @brief Random generator for link draws.
+using node_random::pair_generator;
+
+//! @brief A node as seen by the connector.
+struct bench_node {
+    vec<option::dim> position;
+    option::connect_t::data_type data;
+};
+
+//! @brief Number of directed links delivered in a round, testing every pair of nodes.
+size_t brute_round(option::connect_t const& connector, std::vector<bench_node> const& nodes, size_t r) {
+    size_t links = 0;
+    for (size_t i = 0; i < nodes.size(); ++i)
+        for (size_t j = 0; j < nodes.size(); ++j)
+            if (i != j and connector(pair_generator(r, j, i), nodes[j].data, nodes[j].position, nodes[i].data, nodes[i].position))
+                ++links;
+    return links;
+}
+
+//! @brief Number of directed links delivered in a round, testing candidates in adjacent grid cells only.
+size_t grid_round(option::connect_t const& connector, std::vector<bench_node> const& nodes, size_t r) {
+    spatial::grid_index<option::dim> index(coordination::configurations::communication_range);
+    index.build(nodes.size(), [&](size_t i) -> auto const& { return nodes[i].position; });
+    size_t links = 0;
+    for (size_t i = 0; i < nodes.size(); ++i)
+        index.for_each_candidate(i, [&](size_t j){
+            if (i != j and connector(pair_generator(r, j, i), nodes[j].data, nodes[j].position, nodes[i].data, nodes[i].position))
+                ++links;
+        });
+    return links;
+}
+
+//! @brief The main function (arguments: rounds per point, followed by the node counts to test).
+int main(int argc, char** argv) {
+    using namespace coordination::configurations;
+    using clock_t = std::chrono::steady_clock;
+
+    size_t rounds = argc > 1 ? std::stoul(argv[1]) : 5;
+    std::vector<size_t> sizes;
+    for (int a = 2; a < argc; ++a) sizes.push_back(std::stoul(argv[a]));
+    if (sizes.empty()) sizes = {100, 1000, 10000, 100000};
+
+    std::mt19937_64 gen(42);
+    option::connect_t connector(gen, common::make_tagged_tuple<>());
+    std::cout << "node_num,area_side,mode,rounds_per_sec,links_per_node\n";
+    for (size_t n : sizes) {
+        // constant density: the area grows with the number of nodes
+        double side = area_side * std::sqrt(n / double(node_num));
+        std::uniform_real_distribution<double> pos_d(0, side);
+        std::uniform_int_distribution<int> battery_d(LOW_BATTERY, HIGH_BATTERY);
+        std::vector<bench_node> nodes(n);
+        for (bench_node& b : nodes) {
+            b.position = vec<option::dim>{pos_d(gen), pos_d(gen)};
+            battery::profile const& p = battery::profiles()[battery_d(gen)];
+            common::get<component::tags::sleep_ratio>(b.data) = p.sleep_ratio;
+            common::get<component::tags::send_power_ratio>(b.data) = p.send_power_ratio;
+            common::get<component::tags::recv_power_ratio>(b.data) = p.recv_power_ratio;
+        }
+        size_t grid_links = 0, brute_links = 0;
+        auto start = clock_t::now();
+        for (size_t r = 0; r < rounds; ++r) grid_links += grid_round(connector, nodes, r);
+        double grid_t = std::chrono::duration<double>(clock_t::now() - start).count();
+        std::cout << n << "," << side << ",grid," << rounds / grid_t << "," << grid_links / double(rounds * n) << std::endl;
+        // quadratic scan, skipped when hopelessly slow
+        if (n > 20000) continue;
+        start = clock_t::now();
+        for (size_t r = 0; r < rounds; ++r) brute_links += brute_round(connector, nodes, r);
+        double brute_t = std::chrono::duration<double>(clock_t::now() - start).count();
+        std::cout << n << "," << side << ",brute," << rounds / brute_t << "," << brute_links / double(rounds * n) << std::endl;
+        if (brute_links != grid_links)
+            std::cerr << "mismatch at " << n << " nodes: " << grid_links << " links with the index, " << brute_links << " without" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,289 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file replay.cpp
+ * @brief Records connectivity traces of the case study, and replays the collection algorithms on them.
+ */
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#include "lib/benchmark.hpp"
+#include "lib/case-study.hpp"
+#include "lib/trace.hpp"
+
+using namespace fcpp;
+
+
+//! @brief A field as sent in a message: values for some neighbours (sorted by identifier), zero for the others.
+using sparse_field = std::vector<std::pair<device_t, real_t>>;
+
+//! @brief Value of a sparse field for a given device.
+real_t field_at(sparse_field const& f, device_t uid) {
+    auto it = std::lower_bound(f.begin(), f.end(), uid, [](std::pair<device_t, real_t> const& p, device_t i){
+        return p.first < i;
+    });
+    return it != f.end() and it->first == uid ? it->second : 0;
+}
+
+/**
+ * @brief Port of the collection part of `MAIN` (abf_distance, the connection ratings, sp_collection and ssp_collection) to the replay engine.
+ *
+ * Every `nbr` reads the value exported by the neighbours in the recorded round, and every `old`
+ * the value of the previous round of the node. Fields kept through `old` retain the values of
+ * neighbours not heard in a round, while fields exported through `nbr` only hold the neighbours
+ * heard (as with FCPP fields). As in `oldnbr`, the mixed rating returned is the neighbour value,
+ * while the value stored and exported is the locally evolved one.
+ *
+ * This is a hand-written copy of those functions, not an execution of the FCPP code: a change to
+ * `MAIN` has to be ported here as well. The rounds whose replayed counters differ from the recorded
+ * ones, reported at the end of every replay, show when the two have drifted apart.
+ */
+struct collection_program {
+    //! @brief Number of rating fields (uniconn, biconn, mixed).
+    static constexpr size_t K = 3;
+
+    //! @brief The values exported by a node in a round.
+    struct message_type {
+        //! @brief The abf_distance result.
+        real_t distance;
+        //! @brief The bi_connection field.
+        sparse_field bi;
+        //! @brief The mixed_connection field.
+        sparse_field mixed;
+        //! @brief The sp_collection value.
+        real_t sp_value;
+        //! @brief The sp_collection parent.
+        device_t sp_parent;
+        //! @brief The ssp_collection values.
+        std::array<real_t, K> ssp_value;
+        //! @brief The ssp_collection ratings.
+        std::array<real_t, K> ssp_rating;
+        //! @brief The ssp_collection parents.
+        std::array<device_t, K> ssp_parent;
+    };
+
+    //! @brief The values kept by a node across rounds.
+    struct state_type {
+        //! @brief Whether the node already executed a round.
+        bool started = false;
+        //! @brief The uni_connection field.
+        sparse_field uni;
+        //! @brief The mixed_connection field (as stored and exported).
+        sparse_field mixed;
+        //! @brief The mixed_connection rating (as in node_rating).
+        sparse_field rating;
+        //! @brief The last message of the node.
+        message_type last;
+        //! @brief The results of the last round (classic, uniconn, biconn, mixed).
+        std::array<real_t, K+1> results;
+    };
+
+    //! @brief The stale factor of ssp_collection.
+    real_t stale_factor = 0.7;
+    //! @brief Number of gateways (the sources, nodes 0 to gateway_num-1).
+    device_t gateway_num = 1;
+
+    //! @brief Executes a round.
+    message_type round(trace::round_record const& r, state_type& s, std::vector<std::pair<device_t, message_type const*>> const& inbox) {
+        if (not s.started) {
+            s.last.ssp_value.fill(0);
+            s.last.ssp_rating.fill(0);
+            s.last.ssp_parent.fill(r.uid);
+            s.started = true;
+        }
+        size_t n = inbox.size();
+        message_type m;
+
+        // abf_distance
+        bool source = r.uid < gateway_num;
+        m.distance = source ? 0 : INF;
+        if (not source)
+            for (size_t i = 0; i < n; ++i)
+                m.distance = std::min<real_t>(m.distance, inbox[i].second->distance + r.messages[index(r, inbox[i].first)].distance);
+
+        // connection ratings (the self rating is always zero)
+        std::vector<std::array<real_t, K>> ratings(n);
+        sparse_field uni = s.uni, mixed = s.mixed;
+        for (size_t i = 0; i < n; ++i) {
+            device_t j = inbox[i].first;
+            real_t nb = field_at(inbox[i].second->bi, r.uid);
+            real_t nm = field_at(inbox[i].second->mixed, r.uid);
+            real_t o = field_at(s.mixed, j);
+            ratings[i] = {field_at(s.uni, j) + 1, nb + 1, nm};
+            m.bi.emplace_back(j, nb + 1);
+            set(uni, j, ratings[i][0]);
+            set(mixed, j, (o == 0 ? nm / 2 : o) + 1);
+            set(s.rating, j, nm);
+        }
+        s.uni = std::move(uni);
+        s.mixed = mixed;
+        m.mixed = std::move(mixed);
+
+        // sp_collection
+        std::pair<real_t, device_t> best{m.distance, r.uid};
+        for (size_t i = 0; i < n; ++i)
+            best = std::min(best, std::make_pair(inbox[i].second->distance, inbox[i].first));
+        m.sp_parent = best.second;
+        m.sp_value = 1;
+        for (size_t i = 0; i < n; ++i)
+            if (inbox[i].second->sp_parent == r.uid) m.sp_value += inbox[i].second->sp_value;
+
+        // ssp_collection, for every rating
+        for (size_t k = 0; k < K; ++k) {
+            std::tuple<real_t, real_t, device_t> best_neigh{m.distance, 0, r.uid};
+            real_t folded = 1;
+            for (size_t i = 0; i < n; ++i) {
+                message_type const& x = *inbox[i].second;
+                best_neigh = std::min(best_neigh, std::make_tuple(x.distance, -ratings[i][k], inbox[i].first));
+                if (x.ssp_parent[k] == r.uid) folded += x.ssp_value[k];
+            }
+            real_t rating_evolved = s.last.ssp_rating[k] * stale_factor;
+            device_t parent = s.last.ssp_parent[k];
+            m.ssp_value[k] = folded;
+            if (source) {
+                m.ssp_rating[k] = 0;
+                m.ssp_parent[k] = r.uid;
+            } else if (std::get<2>(best_neigh) != parent and -std::get<1>(best_neigh) < rating_evolved) {
+                m.ssp_rating[k] = rating_evolved;
+                m.ssp_parent[k] = parent;
+            } else {
+                m.ssp_rating[k] = -std::get<1>(best_neigh);
+                m.ssp_parent[k] = std::get<2>(best_neigh);
+            }
+        }
+
+        s.results = {m.sp_value, m.ssp_value[0], m.ssp_value[1], m.ssp_value[2]};
+        s.last = m;
+        return m;
+    }
+
+    //! @brief The bytes of a message (the sparse fields included).
+    size_t bytes(message_type const& m) const {
+        return sizeof(m) + (m.bi.size() + m.mixed.size()) * sizeof(std::pair<device_t, real_t>);
+    }
+
+    //! @brief The rating of a neighbour (used by rating-based eviction policies).
+    real_t rating(state_type const& s, device_t uid) const {
+        return field_at(s.rating, uid);
+    }
+
+  private:
+    //! @brief Index of a sender in the messages of a record.
+    static size_t index(trace::round_record const& r, device_t uid) {
+        return std::lower_bound(r.messages.begin(), r.messages.end(), uid, [](trace::heard const& h, device_t i){
+            return h.uid < i;
+        }) - r.messages.begin();
+    }
+
+    //! @brief Sets the value of a sparse field for a given device.
+    static void set(sparse_field& f, device_t uid, real_t v) {
+        auto it = std::lower_bound(f.begin(), f.end(), uid, [](std::pair<device_t, real_t> const& p, device_t i){
+            return p.first < i;
+        });
+        if (it != f.end() and it->first == uid) it->second = v;
+        else f.emplace(it, uid, v);
+    }
+};
+
+#if AP_TRACE
+//! @brief Runs a simulation of the case study, recording its connectivity trace.
+void record(std::string const& path, size_t seed) {
+    //! @brief The network object type (batch simulator with the general options).
+    using net_t = component::batch_simulator<option::list>::net;
+    option::plot_t plotter;
+    auto init_v = common::make_tagged_tuple<option::seed, option::output, option::plotter>(seed, &bench::null_stream(), &plotter);
+    trace::recorder out(path);
+    trace::recorder::active() = &out;
+    auto start = std::chrono::steady_clock::now();
+    {
+        net_t network{init_v};
+        coordination::run_network(network);
+    }
+    trace::recorder::active() = nullptr;
+    std::cerr << "simulated and recorded in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s" << std::endl;
+}
+#endif
+
+//! @brief Replays a trace, writing the source counters (recorded and replayed) in CSV format.
+template <typename Q>
+void replay(std::string const& path, real_t stale_factor, device_t gateway_num, size_t capacity, Q policy, std::ostream& out) {
+    collection_program program;
+    program.stale_factor = stale_factor;
+    program.gateway_num = gateway_num;
+    std::array<size_t, 4> mismatches = {0, 0, 0, 0};
+    auto start = std::chrono::steady_clock::now();
+    trace::reader in(path);
+    out << "time,classic,uniconn,biconn,mixed,replay_classic,replay_uniconn,replay_biconn,replay_mixed\n";
+    trace::replay_report report = trace::replay(in, program, 16, capacity, policy, [&](trace::round_record const& r, collection_program::state_type const& s){
+        for (size_t k = 0; k < 4; ++k)
+            if (std::abs(s.results[k] - r.results[k]) > 1e-3 * std::max<real_t>(1, std::abs(r.results[k]))) ++mismatches[k];
+        if (r.uid != 0) return;
+        out << r.time;
+        for (float x : r.results) out << "," << x;
+        for (real_t x : s.results) out << "," << x;
+        out << "\n";
+    });
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "replayed " << report.rounds << " rounds in " << wall << "s (" << (wall > 0 ? report.rounds / wall : 0) << " rounds/s)" << std::endl;
+    if (report.rounds == 0) {
+        std::cerr << "the trace has no rounds" << std::endl;
+        return;
+    }
+    std::cerr << "retention: " << report.retained / double(report.rounds) << " messages per round, at most " << report.peak_retained
+              << " per node (" << report.peak_bytes << " bytes with payload), " << report.evictions << " evictions" << std::endl;
+    std::cerr << "rounds differing from the recording: classic " << mismatches[0] << ", uniconn " << mismatches[1]
+              << ", biconn " << mismatches[2] << ", mixed " << mismatches[3] << std::endl;
+}
+
+/**
+ * @brief The main function.
+ *
+ * Arguments:
+ * - `--record`: simulates a run and records its trace to the given file (requires `-DAP_TRACE=1`);
+ * - `--seed`: the seed of the recorded run (0 by default);
+ * - `--replay`: replays the trace in the given file, writing source counters to standard output;
+ * - `--stale`: the stale factor of ssp_collection in replays (0.7 by default);
+ * - `--gateways`: the number of gateways, of the recorded run or of the trace to replay (1 by default);
+ * - `--capacity`: the maximum number of messages retained by a node in replays (unbounded by default);
+ * - `--policy`: the eviction policy of replays, `oldest` (default) or `rating` (lowest node_rating first).
+ */
+int main(int argc, char** argv) {
+    std::string rec = bench::get_arg(argc, argv, "record", "");
+    std::string rep = bench::get_arg(argc, argv, "replay", "");
+    if (rec.empty() and rep.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--gateways <n>] [--record <trace> [--seed <n>]] [--replay <trace> [--stale <factor>] [--capacity <n>] [--policy oldest|rating]]" << std::endl;
+        return 1;
+    }
+    device_t gateways = std::min<device_t>(std::stoul(bench::get_arg(argc, argv, "gateways", "1")), coordination::configurations::node_num);
+    std::string policy = bench::get_arg(argc, argv, "policy", "oldest");
+    if (policy != "oldest" and policy != "rating") {
+        std::cerr << "unknown policy " << policy << " (expected oldest or rating)" << std::endl;
+        return 1;
+    }
+    if (not rec.empty()) {
+#if AP_TRACE
+        coordination::configurations::parameters().gateway_num = gateways;
+        record(rec, std::stoul(bench::get_arg(argc, argv, "seed", "0")));
+#else
+        std::cerr << "recording requires compiling with -DAP_TRACE=1" << std::endl;
+        return 1;
+#endif
+    }
+    if (not rep.empty()) {
+        real_t stale = std::stod(bench::get_arg(argc, argv, "stale", "0.7"));
+        size_t capacity = std::stoull(bench::get_arg(argc, argv, "capacity", std::to_string(std::numeric_limits<size_t>::max())));
+        if (policy == "rating")
+            replay(rep, stale, gateways, capacity, retention::lowest_rating_first{}, std::cout);
+        else
+            replay(rep, stale, gateways, capacity, retention::oldest_first{}, std::cout);
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file scaling.cpp
+ * @brief Scaling benchmark of the case study over node number, communication range and area side.
+ */
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "lib/benchmark.hpp"
+#include "lib/case-study.hpp"
+
+using namespace fcpp;
+
+
+//! @brief A point of the scaling sweep.
+struct scaling_point {
+    size_t node_num;
+    real_t communication_range;
+    real_t area_side;
+    device_t gateway_num;
+    size_t seed;
+};
+
+//! @brief Runs a simulation for the given point, printing a CSV row with its measurements.
+void run_point(scaling_point const& p) {
+    using namespace coordination::tags;
+    //! @brief The network object type (batch simulator with runtime scenario options).
+    using net_t = component::batch_simulator<option::scenario_list>::net;
+    coordination::configurations::parameters().gateway_num = p.gateway_num;
+    auto start = std::chrono::steady_clock::now();
+    //! @brief The initialisation values.
+    auto init_v = common::make_tagged_tuple<option::seed, option::output, scenario_node_num, scenario_area_side, component::tags::radius>(
+        p.seed,
+        &bench::null_stream(),
+        p.node_num,
+        p.area_side,
+        p.communication_range
+    );
+    net_t network{init_v};
+    double startup = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // startup: node creation at time 0, excluding the other events at time 0 (the first log)
+    while (network.next() <= 0) {
+        size_t nodes = network.node_size();
+        auto event_start = std::chrono::steady_clock::now();
+        network.update();
+        if (network.node_size() > nodes) startup += std::chrono::duration<double>(std::chrono::steady_clock::now() - event_start).count();
+    }
+    coordination::run_network(network);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double rounds = 0, neighbours = 0, evictions = 0, retention_bytes = 0;
+    for (device_t uid = 0; uid < network.node_size(); ++uid) {
+        rounds += network.node_at(uid).storage(node_round_count{});
+        neighbours += network.node_at(uid).storage(node_neighbour_count{});
+        evictions += network.node_at(uid).storage(node_retention_evictions{});
+        retention_bytes += network.node_at(uid).storage(node_retention_bytes{});
+    }
+    // network totals, converged when the partial counters of the last gateway did
+    std::array<real_t, 4> counters = {0, 0, 0, 0};
+    real_t converged = 0;
+    for (device_t g = 0; g < p.gateway_num and g < network.node_size(); ++g) {
+        auto& source = network.node_at(g);
+        counters[0] += source.storage(source_alert_counter<classic>{});
+        counters[1] += source.storage(source_alert_counter<uniconn>{});
+        counters[2] += source.storage(source_alert_counter<biconn>{});
+        counters[3] += source.storage(source_alert_counter<mixed>{});
+        converged = std::max(converged, source.storage(convergence_time{}));
+    }
+    std::cout << p.node_num << "," << p.communication_range << "," << p.area_side << "," << p.gateway_num << "," << p.seed << ","
+              << startup << "," << wall << "," << rounds << "," << rounds / wall << "," << neighbours / rounds << ","
+              << bench::peak_rss_kb() << "," << evictions << "," << retention_bytes / network.node_size() << "," << converged << ","
+              << counters[0] << "," << counters[1] << "," << counters[2] << "," << counters[3] << std::endl;
+}
+
+/**
+ * @brief The main function.
+ *
+ * Arguments (all optional, lists are comma-separated):
+ * - `--nodes`: node numbers to test;
+ * - `--range`: communication ranges to test;
+ * - `--side`: area sides to test;
+ * - `--gateways`: gateway numbers to test (at most the number of nodes);
+ * - `--capacity`: the maximum number of messages held by the retention store of a node (unbounded by default);
+ * - `--density`: `constant` to scale the area side with the node number (sides refer to the first node number), `given` to use sides as they are;
+ * - `--seeds`: number of random seeds for every point.
+ */
+int main(int argc, char** argv) {
+    using namespace coordination::configurations;
+    std::vector<size_t> nodes = bench::parse_list<size_t>(bench::get_arg(argc, argv, "nodes", "100,1000,10000"));
+    std::vector<real_t> ranges = bench::parse_list<real_t>(bench::get_arg(argc, argv, "range", std::to_string(communication_range)));
+    std::vector<real_t> sides = bench::parse_list<real_t>(bench::get_arg(argc, argv, "side", std::to_string(area_side)));
+    std::vector<device_t> gateways = bench::parse_list<device_t>(bench::get_arg(argc, argv, "gateways", "1"));
+    bool constant_density = bench::get_arg(argc, argv, "density", "constant") == "constant";
+    size_t seeds = std::stoul(bench::get_arg(argc, argv, "seeds", "1"));
+    parameters().retention_capacity = std::stoull(bench::get_arg(argc, argv, "capacity", std::to_string(std::numeric_limits<size_t>::max())));
+
+    std::cout << "node_num,communication_range,area_side,gateway_num,seed,startup_time,wall_time,rounds,rounds_per_sec,neighbours_per_round,peak_rss_kb,retention_evictions,retention_bytes_per_node,convergence_time,classic,uniconn,biconn,mixed" << std::endl;
+    for (size_t n : nodes)
+        for (real_t r : ranges)
+            for (real_t s : sides)
+                for (device_t g : gateways)
+                    for (size_t seed = 0; seed < seeds; ++seed) {
+                        scaling_point p{n, r, constant_density ? s * std::sqrt(n / real_t(nodes[0])) : s, std::min<device_t>(g, n), seed};
+                        // every point in its own process, so that peak memory is measured separately
+                        if (not bench::run_isolated([&](){ run_point(p); }))
+                            std::cerr << "run failed: " << n << " nodes, range " << r << ", side " << p.area_side << ", " << g << " gateways, seed " << seed << std::endl;
+                    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file soa.cpp
+ * @brief Throughput benchmark of the synchronous structure-of-arrays engine on the case study.
+ */
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include "lib/benchmark.hpp"
+#include "lib/case-study.hpp"
+#include "lib/soa-engine.hpp"
+
+using namespace fcpp;
+
+
+//! @brief Runs the engine for the given number of nodes and rounds, printing a CSV row with its measurements.
+void run_point(size_t node_num, size_t rounds, device_t gateways, size_t window, size_t threads, size_t seed) {
+    using namespace coordination::configurations;
+    using point_type = soa::engine<dim>::point_type;
+    // same scenario as MAIN, with constant density
+    double side = area_side * std::sqrt(node_num / double(coordination::configurations::node_num));
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> pos_d(0, side), seed_d(0, 1);
+    std::uniform_int_distribution<int> level_d(0, battery::max_level);
+    std::vector<point_type> positions(node_num);
+    std::vector<double> seeds(node_num);
+    std::vector<int> levels(node_num);
+    for (size_t i = 0; i < node_num; ++i) {
+        for (size_t d = 0; d < dim; ++d) positions[i][d] = pos_d(gen);
+        seeds[i] = seed_d(gen);
+        levels[i] = level_d(gen);
+    }
+    coordination::configurations::parameters_t const& p = parameters();
+    auto start = std::chrono::steady_clock::now();
+    soa::engine<dim> engine(positions, communication_range, seeds, levels, p.stale_factor, battery::geometric{p.increase_battery_prob, p.decrease_battery_prob}, gateways, window, threads);
+    double setup = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // the connection predicate of the case study, with the radio profiles updated by the engine
+    option::connect_t connector(gen, common::make_tagged_tuple<>());
+    std::vector<option::connect_t::data_type> data(node_num);
+    std::vector<vec<dim>> where(node_num);
+    for (size_t i = 0; i < node_num; ++i)
+        for (size_t d = 0; d < dim; ++d) where[i][d] = positions[i][d];
+    auto link = [&](size_t r, size_t j, size_t i){
+        return connector(node_random::pair_generator(r, j, i), data[j], where[j], data[i], where[i]);
+    };
+    double links = 0;
+    start = std::chrono::steady_clock::now();
+    auto update = [&](size_t i, battery::profile const& b){
+        common::get<component::tags::sleep_ratio>(data[i]) = b.sleep_ratio;
+        common::get<component::tags::send_power_ratio>(data[i]) = b.send_power_ratio;
+        common::get<component::tags::recv_power_ratio>(data[i]) = b.recv_power_ratio;
+    };
+    for (size_t r = 0; r < rounds; ++r) {
+        engine.round(link, update);
+        links += engine.links();
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::array<real_t, 4> c = engine.source_counters();
+    std::cout << node_num << "," << engine.edges() << "," << rounds << "," << setup << "," << wall << "," << node_num * rounds / wall << ","
+              << links / (node_num * double(rounds)) << "," << c[0] << "," << c[1] << "," << c[2] << "," << c[3] << std::endl;
+}
+
+/**
+ * @brief The main function.
+ *
+ * Arguments (all optional):
+ * - `--nodes`: comma-separated node numbers to test (with the density of the configured scenario);
+ * - `--rounds`: number of synchronous rounds (`end` by default);
+ * - `--gateways`: number of gateways (the configured `gateway_num` by default);
+ * - `--window`: number of rounds for which a message is used after the round it was sent in (5 by default, as `retain`);
+ * - `--threads`: number of threads sweeping over nodes (1 by default);
+ * - `--seed`: random seed of the scenario.
+ */
+int main(int argc, char** argv) {
+    std::vector<size_t> nodes = bench::parse_list<size_t>(bench::get_arg(argc, argv, "nodes", "100,1000,10000,100000"));
+    size_t rounds = std::stoul(bench::get_arg(argc, argv, "rounds", std::to_string(coordination::configurations::end)));
+    device_t gateways = std::stoul(bench::get_arg(argc, argv, "gateways", std::to_string(coordination::configurations::parameters().gateway_num)));
+    size_t window = std::stoul(bench::get_arg(argc, argv, "window", "5"));
+    size_t threads = std::stoul(bench::get_arg(argc, argv, "threads", "1"));
+    size_t seed = std::stoul(bench::get_arg(argc, argv, "seed", "0"));
+
+    std::cout << "node_num,edges,rounds,setup_time,wall_time,node_rounds_per_sec,links_per_node,classic,uniconn,biconn,mixed" << std::endl;
+    for (size_t n : nodes) run_point(n, rounds, gateways, window, threads, seed);
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file sweep.cpp
+ * @brief Parameter sweep of the case study, sharing the warm-up of every seed by forking the process.
+ *
+ * Continuations are copies of the process, not snapshots: nothing is written to disk, so a sweep
+ * cannot be resumed. Forking a process whose simulation runs rounds on several threads (`AP_PARALLEL`)
+ * leaves the child with a single thread, so the sweep refuses to run when built that way.
+ */
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+#include "lib/benchmark.hpp"
+#include "lib/case-study.hpp"
+
+using namespace fcpp;
+
+
+//! @brief The network object type (batch simulator with the general options).
+using net_t = component::batch_simulator<option::list>::net;
+
+//! @brief Completes a (forked) simulation with the given parameters, printing a CSV row with the final source counters.
+void continuation(net_t& network, size_t seed, real_t warmup, coordination::configurations::parameters_t const& p) {
+    using namespace coordination::tags;
+    coordination::configurations::parameters() = p;
+    auto start = std::chrono::steady_clock::now();
+    coordination::run_network(network);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // totals over the gateways, converged when the last of them did
+    std::array<real_t, 4> counters = {0, 0, 0, 0};
+    real_t converged = 0;
+    for (device_t g = 0; g < p.gateway_num and g < network.node_size(); ++g) {
+        auto& source = network.node_at(g);
+        counters[0] += source.storage(source_alert_counter<classic>{});
+        counters[1] += source.storage(source_alert_counter<uniconn>{});
+        counters[2] += source.storage(source_alert_counter<biconn>{});
+        counters[3] += source.storage(source_alert_counter<mixed>{});
+        converged = std::max(converged, source.storage(convergence_time{}));
+    }
+    std::cout << seed << "," << p.stale_factor << "," << p.increase_battery_prob << "," << p.decrease_battery_prob << "," << p.gateway_num << "," << warmup << ","
+              << counters[0] << "," << counters[1] << "," << counters[2] << "," << counters[3] << ","
+              << converged << "," << wall << std::endl;
+}
+
+/**
+ * @brief The main function.
+ *
+ * Arguments (all optional, lists are comma-separated):
+ * - `--stale`: stale factors to test;
+ * - `--increase`: battery increase probabilities to test;
+ * - `--decrease`: battery decrease probabilities to test;
+ * - `--gateways`: number of gateways, in the warm-up and every continuation (1 by default, at most the number of nodes);
+ * - `--warmup`: simulated time shared by all the continuations of a seed (with default parameters);
+ * - `--seeds`: number of random seeds.
+ */
+int main(int argc, char** argv) {
+#if AP_PARALLEL
+    std::cerr << "sweep forks the warm-up of every seed, which is unsafe with parallel rounds: build it with AP_PARALLEL=0" << std::endl;
+    return 1;
+#endif
+    coordination::configurations::parameters_t defaults;
+    std::vector<real_t> stales = bench::parse_list<real_t>(bench::get_arg(argc, argv, "stale", std::to_string(defaults.stale_factor)));
+    std::vector<real_t> increases = bench::parse_list<real_t>(bench::get_arg(argc, argv, "increase", std::to_string(defaults.increase_battery_prob)));
+    std::vector<real_t> decreases = bench::parse_list<real_t>(bench::get_arg(argc, argv, "decrease", std::to_string(defaults.decrease_battery_prob)));
+    real_t warmup = std::stod(bench::get_arg(argc, argv, "warmup", "50"));
+    size_t seeds = std::stoul(bench::get_arg(argc, argv, "seeds", "1"));
+    defaults.gateway_num = std::min<device_t>(std::stoul(bench::get_arg(argc, argv, "gateways", "1")), coordination::configurations::node_num);
+
+    std::cout << "seed,stale_factor,increase_battery_prob,decrease_battery_prob,gateway_num,warmup,classic,uniconn,biconn,mixed,convergence_time,wall_time" << std::endl;
+    for (size_t seed = 0; seed < seeds; ++seed) {
+        coordination::configurations::parameters() = defaults;
+        option::plot_t plotter;
+        auto init_v = common::make_tagged_tuple<option::seed, option::output, option::plotter>(seed, &bench::null_stream(), &plotter);
+        net_t network{init_v};
+        // shared warm-up, executed once for all the parameter combinations
+        auto start = std::chrono::steady_clock::now();
+        while (network.next() < warmup) network.update();
+        std::cerr << "seed " << seed << ": warm-up to " << warmup << "s in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s" << std::endl;
+        // every continuation in a forked copy of the whole simulation state
+        for (real_t s : stales)
+            for (real_t i : increases)
+                for (real_t d : decreases) {
+                    coordination::configurations::parameters_t p{s, i, d, defaults.gateway_num};
+                    if (not bench::run_isolated([&](){ continuation(network, seed, warmup, p); }))
+                        std::cerr << "continuation failed: seed " << seed << ", stale " << s << ", increase " << i << ", decrease " << d << std::endl;
+                }
+    }
+    return 0;
+}
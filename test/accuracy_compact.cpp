@@ -0,0 +1,56 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file accuracy_compact.cpp
+ * @brief Test of the collection results with compact exports against a reference run with plain exports.
+ *
+ * For every simulated second of every run, the source counters summed over the gateways are
+ * compared with the reference. The test fails if the mean absolute difference of any counter
+ * exceeds the tolerance, as a fraction of the number of nodes.
+ */
+
+#define AP_COMPACT_EXPORTS 1
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include "test/simulation.hpp"
+
+using namespace fcpp;
+
+
+/**
+ * @brief The main function.
+ *
+ * Arguments:
+ * - `--reference`: file written by accuracy_plain;
+ * - `--seeds`: number of runs, with seeds from 0, as in the reference (5 by default);
+ * - `--tolerance`: largest mean absolute difference accepted, as a fraction of the number of nodes (0.02 by default).
+ */
+int main(int argc, char** argv) {
+    std::string reference = bench::get_arg(argc, argv, "reference", "accuracy-plain.txt");
+    size_t seeds = std::stoul(bench::get_arg(argc, argv, "seeds", "5"));
+    real_t tolerance = std::stod(bench::get_arg(argc, argv, "tolerance", "0.02"));
+    std::vector<test::row> rows;
+    for (size_t seed = 0; seed < seeds; ++seed) {
+        std::vector<test::row> r = test::run_values(seed);
+        rows.insert(rows.end(), r.begin(), r.end());
+    }
+    auto plain = test::source_totals(test::read_rows(reference));
+    auto compact = test::source_totals(rows);
+    if (plain.size() != compact.size()) {
+        std::cerr << "the reference has " << plain.size() << " time points instead of " << compact.size() << std::endl;
+        return 1;
+    }
+    char const* names[] = {"classic", "uniconn", "biconn", "mixed"};
+    bool failed = false;
+    for (size_t k = 0; k < test::source_counters; ++k) {
+        real_t diff = 0;
+        for (size_t t = 0; t < plain.size(); ++t) diff += std::abs(plain[t][k] - compact[t][k]);
+        diff /= plain.size() * coordination::configurations::node_num;
+        failed |= diff > tolerance;
+        std::cerr << names[k] << ": mean absolute difference " << diff << " of the nodes" << (diff > tolerance ? " (FAILED)" : "") << std::endl;
+    }
+    return failed;
+}
@@ -0,0 +1,36 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file accuracy_plain.cpp
+ * @brief Reference run of the case study with plain exports, for the comparison in accuracy_compact.cpp.
+ */
+
+#define AP_COMPACT_EXPORTS 0
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include "test/simulation.hpp"
+
+using namespace fcpp;
+
+
+/**
+ * @brief The main function.
+ *
+ * Arguments:
+ * - `--output`: file where the values of every node are written;
+ * - `--seeds`: number of runs, with seeds from 0 (5 by default).
+ */
+int main(int argc, char** argv) {
+    std::string output = bench::get_arg(argc, argv, "output", "accuracy-plain.txt");
+    size_t seeds = std::stoul(bench::get_arg(argc, argv, "seeds", "5"));
+    std::vector<test::row> rows;
+    for (size_t seed = 0; seed < seeds; ++seed) {
+        std::vector<test::row> r = test::run_values(seed);
+        rows.insert(rows.end(), r.begin(), r.end());
+    }
+    test::write_rows(output, rows);
+    return 0;
+}
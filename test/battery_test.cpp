@@ -0,0 +1,102 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file battery_test.cpp
+ * @brief Monte-Carlo test of the geometric battery model against a draw in every round.
+ *
+ * Many nodes are simulated with both models, drawing from independent node streams as `MAIN` does.
+ * The distribution of the battery levels at several rounds, and the mean number of level changes,
+ * must agree within a tolerance well above their sampling error.
+ */
+
+#include "lib/fcpp.hpp"
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "lib/battery.hpp"
+#include "lib/node-random.hpp"
+
+using namespace fcpp;
+
+
+//! @brief Number of simulated nodes.
+constexpr size_t nodes = 20000;
+//! @brief Number of simulated rounds.
+constexpr int rounds = 250;
+//! @brief Rounds at which the level distributions are compared.
+constexpr std::array<int, 4> checkpoints = {10, 50, 100, 250};
+//! @brief Largest accepted difference between level frequencies (the standard error is below 0.005).
+constexpr real_t tolerance = 0.02;
+
+//! @brief Level frequencies at the checkpoints, and mean number of level changes.
+struct outcome {
+    std::array<std::array<real_t, battery::max_level + 1>, checkpoints.size()> levels{};
+    real_t changes = 0;
+};
+
+//! @brief Draws in every round an increase with probability `up`, and otherwise a decrease with probability `down`.
+outcome bernoulli(real_t up, real_t down) {
+    outcome o;
+    for (size_t i = 0; i < nodes; ++i) {
+        uint64_t key = node_random::key(real_t(i) / nodes);
+        int level = i % (battery::max_level + 1);
+        for (int round = 1, c = 0; round <= rounds; ++round) {
+            int next = level;
+            if (node_random::uniform(key, round, 0) < up) next = std::min(level + 1, battery::max_level);
+            else if (node_random::uniform(key, round, 1) < down) next = std::max(level - 1, 0);
+            o.changes += next != level;
+            level = next;
+            if (round == checkpoints[c]) o.levels[c++][level] += 1.0 / nodes;
+        }
+    }
+    o.changes /= nodes;
+    return o;
+}
+
+//! @brief Draws the rounds of transitions from the geometric model, as `MAIN` does (with a different stream).
+outcome geometric(real_t up, real_t down) {
+    battery::geometric model{up, down};
+    outcome o;
+    for (size_t i = 0; i < nodes; ++i) {
+        uint64_t key = node_random::key(real_t(i) / nodes + 0.5);
+        int level = i % (battery::max_level + 1);
+        int next_transition = model.next_transition(0, node_random::uniform(key, 1, 2));
+        for (int round = 1, c = 0; round <= rounds; ++round) {
+            if (round == next_transition) {
+                int next = model.transition(level, node_random::uniform(key, round, 0));
+                o.changes += next != level;
+                level = next;
+                next_transition = model.next_transition(round, node_random::uniform(key, round, 1));
+            }
+            if (round == checkpoints[c]) o.levels[c++][level] += 1.0 / nodes;
+        }
+    }
+    o.changes /= nodes;
+    return o;
+}
+
+//! @brief The main function.
+int main() {
+    bool failed = false;
+    std::vector<std::array<real_t, 2>> probabilities = {{0.01, 0.01}, {0.05, 0.1}, {0.2, 0.05}, {0.5, 0.5}};
+    for (auto const& p : probabilities) {
+        outcome b = bernoulli(p[0], p[1]);
+        outcome g = geometric(p[0], p[1]);
+        real_t diff = 0;
+        for (size_t c = 0; c < checkpoints.size(); ++c)
+            for (int l = 0; l <= battery::max_level; ++l)
+                diff = std::max(diff, std::abs(b.levels[c][l] - g.levels[c][l]));
+        // level changes are counted over the whole run, so their tolerance is relative
+        real_t change_diff = std::abs(b.changes - g.changes) / std::max<real_t>(b.changes, 1);
+        bool ok = diff <= tolerance and change_diff <= tolerance;
+        failed |= not ok;
+        std::cerr << "up " << p[0] << ", down " << p[1] << ": largest level frequency difference " << diff
+                  << ", mean level changes " << b.changes << " (per round) and " << g.changes << " (geometric)"
+                  << (ok ? "" : " FAILED") << std::endl;
+    }
+    return failed;
+}
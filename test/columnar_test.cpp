@@ -0,0 +1,72 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file columnar_test.cpp
+ * @brief Test of the columnar file format: interleaved blocks, text blocks, run index, text conversion and truncated files.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "lib/columnar.hpp"
+
+using namespace fcpp;
+
+
+//! @brief Number of failed checks.
+size_t failures = 0;
+
+//! @brief Reports a failed check.
+void check(bool ok, char const* what) {
+    if (ok) return;
+    std::cerr << "FAILED: " << what << std::endl;
+    ++failures;
+}
+
+//! @brief The main function (argument: path of the temporary file).
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "columnar-test.bin";
+    std::vector<std::string> names = {"time", "value"};
+    {
+        columnar::writer out(path);
+        out.append_text(names, 1, "# header\n#\n# time value\n");
+        out.append(names, 1, {{1, 2}, {10, 20}});
+        out.append(names, 0, {{1}, {5}});
+        out.append(names, 1, {{3}, {30}});
+        out.append_text(names, 1, "# footer\n");
+    }
+    {
+        columnar::reader in(path);
+        check(in.columns() == 3 and in.name(0) == "run" and in.column("value") == 2, "column names");
+        check(in.rows() == 4 and in.blocks().size() == 5, "rows and blocks");
+        check(in.runs().size() == 2 and in.runs().at(1) == std::vector<size_t>({0, 1, 3, 4}), "run index");
+        check(in.blocks()[3].column(2)[0] == 30, "column values");
+        check(in.blocks()[0].rows == 0 and std::string(in.blocks()[0].text, in.blocks()[0].length) == "# header\n#\n# time value\n", "text block");
+        std::stringstream s;
+        columnar::to_text(in, 1, s);
+        check(s.str() == "# header\n#\n# time value\n1 10\n2 20\n3 30\n# footer\n", "text conversion");
+    }
+    // a file cut inside the last block is rejected
+    std::string data;
+    {
+        std::ifstream in(path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in), {});
+    }
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(data.data(), data.size() - sizeof(double));
+    }
+    bool thrown = false;
+    try {
+        columnar::reader in(path);
+    } catch (std::runtime_error const&) {
+        thrown = true;
+    }
+    check(thrown, "truncated block rejected");
+    std::remove(path.c_str());
+
+    if (failures == 0) std::cerr << "all checks passed" << std::endl;
+    return failures > 0;
+}
@@ -0,0 +1,77 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file compact_test.cpp
+ * @brief Test of the compact wire representations and of the export sizes computed without serialising.
+ */
+
+#include "lib/fcpp.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "lib/compact.hpp"
+
+using namespace fcpp;
+
+
+//! @brief Number of failed checks.
+size_t failures = 0;
+
+//! @brief Reports a failed check.
+void check(bool ok, char const* what) {
+    if (ok) return;
+    std::cerr << "FAILED: " << what << std::endl;
+    ++failures;
+}
+
+//! @brief Number of bytes of a value serialised to a stream.
+template <typename T>
+size_t serialised_size(T const& x) {
+    common::osstream s;
+    s << x;
+    return s.size();
+}
+
+//! @brief The main function.
+int main() {
+    using real8 = compact::fixed_real<8>;
+
+    // quantisation error within half a step, and saturation of infinities
+    real_t max_error = 0;
+    for (real_t x = -1000; x <= 1000; x += 0.0137)
+        max_error = std::max(max_error, std::abs(real_t(real8(x)) - x));
+    check(max_error <= std::ldexp(1.0, -9), "fixed_real error within 2^-(F+1)");
+    check(real_t(real8(INF)) == INF and real_t(real8(-INF)) == -INF, "fixed_real saturates infinities");
+    check(real_t(real8(0.5)) == 0.5 and real_t(real8(-3)) == -3, "fixed_real is exact on multiples of 2^-F");
+
+    // varint round trip and width
+    for (device_t d : {0u, 1u, 127u, 128u, 16383u, 16384u, 1u<<21, 1u<<28, 0xFFFFFFFFu}) {
+        common::osstream os;
+        os << compact::varint_device(d);
+        common::isstream is;
+        is.d = os.d;
+        compact::varint_device r;
+        is >> r;
+        check(device_t(r) == d, "varint_device round trip");
+        check(compact::wire_size(compact::varint_device(d)) == os.size(), "varint_device wire size");
+    }
+    check(compact::wire_size(compact::varint_device(127)) == 1 and compact::wire_size(compact::varint_device(128)) == 2, "varint_device takes one byte per 7 bits");
+
+    // computed sizes match the serialised ones
+    check(compact::wire_size(real8(3.5)) == serialised_size(real8(3.5)), "fixed_real wire size");
+    check(compact::wire_size(real_t(1)) == sizeof(real_t) and compact::wire_size(device_t(1)) == sizeof(device_t), "arithmetic wire size");
+    std::array<real8, 3> a{real8(1), real8(2), real8(3)};
+    check(compact::wire_size(a) == 3 * sizeof(int32_t), "array wire size");
+    std::array<compact::varint_device, 3> b{compact::varint_device(1), compact::varint_device(200), compact::varint_device(3)};
+    tuple<std::array<real8, 3>, std::array<compact::varint_device, 3>> t{a, b};
+    check(compact::wire_size(t) == 3 * sizeof(int32_t) + 4, "tuple wire size");
+
+    // fields: an identifier and a value per neighbour, and the default value
+    field<real_t> f = details::make_field(std::vector<device_t>{1, 2, 3}, std::vector<real_t>{0, 1, 2, 3});
+    check(compact::wire_size(f) == 3 * sizeof(device_t) + 4 * sizeof(real_t), "field wire size");
+
+    if (failures == 0) std::cerr << "all checks passed" << std::endl;
+    return failures > 0;
+}
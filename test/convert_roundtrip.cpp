@@ -0,0 +1,90 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file convert_roundtrip.cpp
+ * @brief Test of the columnar format of batch runs against the text output of FCPP.
+ *
+ * A run logged as text by FCPP and the same run logged to a columnar file, then converted with
+ * `columnar::to_text`, must have the same lines: the same header, parameter comments and footer (up to
+ * the digits of comments, which include the wall clock time), and the same rows.
+ */
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <sstream>
+
+#include "lib/benchmark.hpp"
+#include "lib/case-study.hpp"
+#include "lib/columnar.hpp"
+
+using namespace fcpp;
+
+
+//! @brief The network object type (batch simulator with the batch options).
+using net_t = component::batch_simulator<option::batch_list>::net;
+
+//! @brief Splits a text in lines, removing the digits of comment lines.
+std::vector<std::string> lines(std::string const& text) {
+    std::vector<std::string> result;
+    std::stringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (not line.empty() and line[0] == '#') {
+            std::string l;
+            for (char c : line) if (not std::isdigit((unsigned char)c)) l.push_back(c);
+            line = l;
+        }
+        result.push_back(line);
+    }
+    return result;
+}
+
+/**
+ * @brief The main function.
+ *
+ * Arguments (all optional):
+ * - `--output`: path of the temporary columnar file (`convert-roundtrip.bin` by default);
+ * - `--seed`: seed of the run (0 by default).
+ */
+int main(int argc, char** argv) {
+    std::string path = bench::get_arg(argc, argv, "output", "convert-roundtrip.bin");
+    size_t seed = std::stoul(bench::get_arg(argc, argv, "seed", "0"));
+    // the run logged as text by FCPP
+    std::stringstream text;
+    {
+        option::batch_plot_t sink;
+        auto init_v = common::make_tagged_tuple<option::seed, option::output, option::plotter>(seed, &text, &sink);
+        net_t network{init_v};
+        coordination::run_network(network);
+    }
+    // the same run logged to a columnar file
+    {
+        columnar::writer out(path);
+        option::batch_plot_t sink(&out, seed);
+        auto init_v = common::make_tagged_tuple<option::seed, option::output, option::plotter>(seed, sink.output(), &sink);
+        net_t network{init_v};
+        coordination::run_network(network);
+    }
+    std::stringstream converted;
+    {
+        columnar::reader in(path);
+        columnar::to_text(in, seed, converted);
+    }
+    std::remove(path.c_str());
+
+    std::vector<std::string> expected = lines(text.str()), actual = lines(converted.str());
+    size_t differences = 0;
+    for (size_t i = 0; i < std::max(expected.size(), actual.size()); ++i) {
+        std::string const& e = i < expected.size() ? expected[i] : "";
+        std::string const& a = i < actual.size() ? actual[i] : "";
+        if (i < expected.size() and i < actual.size() and e == a) continue;
+        if (differences++ < 10) std::cerr << "line " << i + 1 << ": \"" << e << "\" converted as \"" << a << "\"" << std::endl;
+    }
+    std::cerr << differences << " of " << expected.size() << " lines differ in the conversion (" << actual.size() << " lines converted)" << std::endl;
+    return differences > 0;
+}
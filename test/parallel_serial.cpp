@@ -0,0 +1,36 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file parallel_serial.cpp
+ * @brief Reference run of the case study with serial rounds, for the comparison in parallel_threads.cpp.
+ */
+
+#define AP_PARALLEL 0
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include "test/simulation.hpp"
+
+using namespace fcpp;
+
+
+/**
+ * @brief The main function.
+ *
+ * Arguments:
+ * - `--output`: file where the values of every node are written;
+ * - `--seeds`: number of runs, with seeds from 0 (3 by default).
+ */
+int main(int argc, char** argv) {
+    std::string output = bench::get_arg(argc, argv, "output", "parallel-serial.txt");
+    size_t seeds = std::stoul(bench::get_arg(argc, argv, "seeds", "3"));
+    std::vector<test::row> rows;
+    for (size_t seed = 0; seed < seeds; ++seed) {
+        std::vector<test::row> r = test::run_values(seed);
+        rows.insert(rows.end(), r.begin(), r.end());
+    }
+    test::write_rows(output, rows);
+    return 0;
+}
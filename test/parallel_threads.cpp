@@ -0,0 +1,63 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file parallel_threads.cpp
+ * @brief Test of the case study with parallel rounds against a reference run with serial rounds.
+ *
+ * The values of every node at every simulated second must be identical to the reference, bit by bit,
+ * with every number of threads and in every repeated execution.
+ */
+
+#define AP_PARALLEL 1
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include "test/simulation.hpp"
+
+using namespace fcpp;
+
+
+/**
+ * @brief The main function.
+ *
+ * Arguments:
+ * - `--reference`: file written by parallel_serial;
+ * - `--seeds`: number of runs, with seeds from 0, as in the reference (3 by default);
+ * - `--threads`: comma-separated numbers of threads executing the rounds (1,2,4 by default);
+ * - `--repeat`: number of executions with every number of threads (2 by default).
+ */
+int main(int argc, char** argv) {
+    std::string reference = bench::get_arg(argc, argv, "reference", "parallel-serial.txt");
+    size_t seeds = std::stoul(bench::get_arg(argc, argv, "seeds", "3"));
+    std::vector<size_t> threads = bench::parse_list<size_t>(bench::get_arg(argc, argv, "threads", "1,2,4"));
+    size_t repeat = std::stoul(bench::get_arg(argc, argv, "repeat", "2"));
+    std::vector<test::row> serial = test::read_rows(reference);
+    size_t failures = 0;
+    for (size_t n : threads)
+        for (size_t x = 0; x < repeat; ++x) {
+            std::vector<test::row> rows;
+            for (size_t seed = 0; seed < seeds; ++seed) {
+                std::vector<test::row> r = test::run_values(seed, coordination::configurations::end, n);
+                rows.insert(rows.end(), r.begin(), r.end());
+            }
+            if (serial.size() != rows.size()) {
+                std::cerr << "the reference has " << serial.size() << " rows instead of " << rows.size() << " with " << n << " threads" << std::endl;
+                ++failures;
+                continue;
+            }
+            size_t differences = 0;
+            for (size_t r = 0; r < rows.size(); ++r) {
+                if (rows[r] == serial[r]) continue;
+                if (differences++ < 10) {
+                    std::cerr << "time " << rows[r][0] << ", node " << rows[r][1] << ":";
+                    for (size_t k = 2; k < test::row_size; ++k) std::cerr << " " << serial[r][k] << "/" << rows[r][k];
+                    std::cerr << std::endl;
+                }
+            }
+            std::cerr << differences << " of " << rows.size() << " node values differ from the serial run with " << n << " threads (execution " << x + 1 << ")" << std::endl;
+            failures += differences > 0;
+        }
+    return failures > 0;
+}
@@ -0,0 +1,107 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file simulation.hpp
+ * @brief Helpers for tests comparing runs of the case study built with different options.
+ *
+ * A run is summarised by the values of every node at every simulated second. Tests built with a
+ * reference configuration write them to a file, and tests built with the configuration under test
+ * compare their own values against the file.
+ */
+
+#ifndef CASE_STUDY_TEST_SIMULATION_H_
+#define CASE_STUDY_TEST_SIMULATION_H_
+
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib/benchmark.hpp"
+#include "lib/case-study.hpp"
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+//! @brief Namespace for test utilities.
+namespace test {
+
+//! @brief Number of values of a row: time, node, battery level, then node and source counters (classic, uniconn, biconn, mixed).
+constexpr size_t row_size = 11;
+
+//! @brief The values of a node at a simulated second.
+using row = std::array<real_t, row_size>;
+
+//! @brief Runs the case study with the general options (and the given threads for parallel rounds), collecting the values of every node at every simulated second.
+inline std::vector<row> run_values(size_t seed, size_t until = coordination::configurations::end, size_t threads = std::thread::hardware_concurrency()) {
+    using namespace coordination::tags;
+    //! @brief The network object type (batch simulator with the general options).
+    using net_t = component::batch_simulator<option::list>::net;
+    option::plot_t plotter;
+    auto init_v = common::make_tagged_tuple<option::seed, option::output, option::plotter, option::threads>(seed, &bench::null_stream(), &plotter, threads);
+    net_t network{init_v};
+    std::vector<row> rows;
+    for (size_t t = 1; t <= until; ++t) {
+        while (network.next() < t) network.update();
+        for (device_t uid = 0; uid < network.node_size(); ++uid) {
+            auto& n = network.node_at(uid);
+            rows.push_back({
+                (real_t)t, (real_t)uid, (real_t)n.storage(node_battery_level{}),
+                n.storage(node_alert_counter<classic>{}), n.storage(node_alert_counter<uniconn>{}),
+                n.storage(node_alert_counter<biconn>{}), n.storage(node_alert_counter<mixed>{}),
+                n.storage(source_alert_counter<classic>{}), n.storage(source_alert_counter<uniconn>{}),
+                n.storage(source_alert_counter<biconn>{}), n.storage(source_alert_counter<mixed>{})
+            });
+        }
+    }
+    return rows;
+}
+
+//! @brief Writes rows to a file, with enough digits to read the same values back.
+inline void write_rows(std::string const& path, std::vector<row> const& rows) {
+    std::ofstream out(path);
+    if (not out) throw std::runtime_error("cannot open " + path);
+    out << std::setprecision(std::numeric_limits<real_t>::max_digits10);
+    for (row const& r : rows) {
+        for (size_t k = 0; k < row_size; ++k) out << (k ? " " : "") << r[k];
+        out << "\n";
+    }
+}
+
+//! @brief Reads rows from a file written by write_rows.
+inline std::vector<row> read_rows(std::string const& path) {
+    std::ifstream in(path);
+    if (not in) throw std::runtime_error("cannot open " + path);
+    std::vector<row> rows;
+    row r;
+    while (in >> r[0]) {
+        for (size_t k = 1; k < row_size; ++k) in >> r[k];
+        rows.push_back(r);
+    }
+    return rows;
+}
+
+//! @brief Number of source counters in a row (classic, uniconn, biconn, mixed), following the node counters.
+constexpr size_t source_counters = 4;
+
+//! @brief Sums the source counters of the rows of each simulated second (consecutive rows with the same time).
+inline std::vector<std::array<real_t, source_counters>> source_totals(std::vector<row> const& rows) {
+    std::vector<std::array<real_t, source_counters>> totals;
+    for (size_t r = 0; r < rows.size(); ++r) {
+        if (r == 0 or rows[r][0] != rows[r-1][0]) totals.push_back({0, 0, 0, 0});
+        for (size_t k = 0; k < source_counters; ++k) totals.back()[k] += rows[r][row_size - source_counters + k];
+    }
+    return totals;
+}
+
+} // namespace test
+
+} // namespace fcpp
+
+#endif // CASE_STUDY_TEST_SIMULATION_H_
@@ -0,0 +1,160 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file soa_equivalence.cpp
+ * @brief Test of the structure-of-arrays engine against `MAIN` run by FCPP with synchronised rounds.
+ *
+ * FCPP runs the configured scenario with rounds at every integer time and messages delivered after
+ * half a second, over links drawn by a predicate shared with the engine. The engine is built from the
+ * positions, random seeds and battery levels of the FCPP nodes, and the counters of every node after
+ * every round must be identical.
+ */
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include <map>
+
+#include "lib/benchmark.hpp"
+#include "lib/case-study.hpp"
+#include "lib/soa-engine.hpp"
+
+using namespace fcpp;
+
+
+//! @brief Namespace for the links shared by the two executions.
+namespace equivalence {
+
+//! @brief Probability of a link between two nodes within communication range.
+constexpr double link_prob = 0.7;
+
+//! @brief The round whose messages are being sent.
+size_t send_round = 0;
+
+//! @brief The identifiers of the nodes, by position.
+std::map<std::array<double, coordination::configurations::dim>, device_t> uid;
+
+//! @brief Whether the message sent by j in the previous round reaches i in a round.
+inline bool link(size_t round, size_t j, size_t i) {
+    return node_random::uniform(j * coordination::configurations::node_num + i + 1, round) < link_prob;
+}
+
+//! @brief The position of a node as a key of uid.
+template <typename P>
+std::array<double, coordination::configurations::dim> key(P const& p) {
+    std::array<double, coordination::configurations::dim> k;
+    for (size_t d = 0; d < k.size(); ++d) k[d] = p[d];
+    return k;
+}
+
+//! @brief Connection predicate drawing the links of the nodes found in uid (with the data of the case study connector).
+class connector {
+  public:
+    //! @brief The data type of a node (radio profiles are written by MAIN and ignored).
+    using data_type = option::connect_t::data_type;
+
+    //! @brief The type of node positions.
+    using position_type = vec<coordination::configurations::dim>;
+
+    //! @brief Generator and tagged tuple constructor.
+    template <typename G, typename S, typename T>
+    connector(G&&, common::tagged_tuple<S,T> const&) {}
+
+    //! @brief The maximum radius of connection.
+    real_t maximum_radius() const {
+        return coordination::configurations::communication_range;
+    }
+
+    //! @brief Checks whether a message sent from the first position reaches the second.
+    template <typename G>
+    bool operator()(G&&, data_type const&, position_type const& position1, data_type const&, position_type const& position2) const {
+        return norm(position1 - position2) <= maximum_radius() and link(send_round + 1, uid.at(key(position1)), uid.at(key(position2)));
+    }
+};
+
+} // namespace equivalence
+
+namespace fcpp {
+
+namespace option {
+
+//! @brief Rounds of every node at every integer time, starting from 1.
+using equivalence_round_s = sequence::periodic_n<1, 1, 1, coordination::configurations::end>;
+
+//! @brief The general simulation options, with synchronised rounds and the links of the test.
+DECLARE_OPTIONS(equivalence_list,
+    synchronised<true>,
+    round_schedule<equivalence_round_s>,
+    delay<distribution::constant_n<times_t, 1, 2>>,
+    connector<equivalence::connector>,
+    common_list,
+    fixed_scenario,
+    plot_type<plot_t>
+);
+
+} // namespace option
+
+} // namespace fcpp
+
+
+/**
+ * @brief The main function.
+ *
+ * Arguments:
+ * - `--gateways`: number of gateways (2 by default);
+ * - `--rounds`: number of rounds (50 by default);
+ * - `--seed`: random seed of the scenario.
+ */
+int main(int argc, char** argv) {
+    using namespace coordination::tags;
+    using namespace coordination::configurations;
+    device_t gateways = std::stoul(bench::get_arg(argc, argv, "gateways", "2"));
+    size_t rounds = std::stoul(bench::get_arg(argc, argv, "rounds", "50"));
+    size_t seed = std::stoul(bench::get_arg(argc, argv, "seed", "0"));
+    parameters().gateway_num = gateways;
+
+    using net_t = component::batch_simulator<option::equivalence_list>::net;
+    option::plot_t plotter;
+    auto init_v = common::make_tagged_tuple<option::seed, option::output, option::plotter>(seed, &bench::null_stream(), &plotter);
+    net_t network{init_v};
+    // nodes are created at time 0, before the first round
+    while (network.next() < 0.5) network.update();
+    using point_type = soa::engine<dim>::point_type;
+    std::vector<point_type> positions(network.node_size());
+    std::vector<double> seeds(network.node_size());
+    std::vector<int> levels(network.node_size());
+    for (device_t i = 0; i < network.node_size(); ++i) {
+        auto& n = network.node_at(i);
+        positions[i] = equivalence::key(n.position());
+        seeds[i] = n.storage(node_random_seed{});
+        levels[i] = n.storage(node_battery_level{});
+        equivalence::uid[positions[i]] = i;
+    }
+    parameters_t const& p = parameters();
+    soa::engine<dim> engine(positions, communication_range, seeds, levels, p.stale_factor, battery::geometric{p.increase_battery_prob, p.decrease_battery_prob}, gateways, 5);
+
+    size_t differences = 0;
+    for (size_t t = 1; t <= rounds; ++t) {
+        // rounds at time t, and the deliveries of their messages at time t + 1/2
+        equivalence::send_round = t;
+        while (network.next() < t + 0.75) network.update();
+        engine.round(equivalence::link);
+        for (device_t i = 0; i < network.node_size(); ++i) {
+            auto& n = network.node_at(i);
+            std::array<real_t, 4> expected = {
+                n.storage(node_alert_counter<classic>{}), n.storage(node_alert_counter<uniconn>{}),
+                n.storage(node_alert_counter<biconn>{}), n.storage(node_alert_counter<mixed>{})
+            };
+            std::array<real_t, 4> found = engine.node_counters(i);
+            if (found == expected) continue;
+            if (differences++ < 10) {
+                std::cerr << "round " << t << ", node " << i << ":";
+                for (size_t k = 0; k < found.size(); ++k) std::cerr << " " << expected[k] << "/" << found[k];
+                std::cerr << std::endl;
+            }
+        }
+    }
+    std::cerr << differences << " of " << rounds * network.node_size() << " node counters differ from FCPP" << std::endl;
+    return differences > 0;
+}
@@ -0,0 +1,80 @@
+// Copyright © 2024 Giorgio Audrito, Daniele Bortoluzzi, Giordano Scarso. All Rights Reserved.
+
+/**
+ * @file soa_threads.cpp
+ * @brief Test of the structure-of-arrays engine with several threads against a single thread.
+ *
+ * Engines built with 1 and 4 threads from the same scenario must have the same adjacency, and the
+ * same counters for every node after every round.
+ */
+
+// [INTRODUCTION]
+//! Importing the FCPP library.
+#include "lib/fcpp.hpp"
+
+#include <random>
+
+#include "lib/benchmark.hpp"
+#include "lib/case-study.hpp"
+#include "lib/soa-engine.hpp"
+
+using namespace fcpp;
+
+
+/**
+ * @brief The main function.
+ *
+ * Arguments (all optional):
+ * - `--nodes`: number of nodes, with the density of the configured scenario (5000 by default);
+ * - `--rounds`: number of rounds (100 by default);
+ * - `--threads`: number of threads compared against a single one (4 by default).
+ */
+int main(int argc, char** argv) {
+    using namespace coordination::configurations;
+    using point_type = soa::engine<dim>::point_type;
+    size_t node_num = std::stoul(bench::get_arg(argc, argv, "nodes", "5000"));
+    size_t rounds = std::stoul(bench::get_arg(argc, argv, "rounds", "100"));
+    size_t threads = std::stoul(bench::get_arg(argc, argv, "threads", "4"));
+
+    double side = area_side * std::sqrt(node_num / double(coordination::configurations::node_num));
+    std::mt19937_64 gen(0);
+    std::uniform_real_distribution<double> pos_d(0, side), seed_d(0, 1);
+    std::uniform_int_distribution<int> level_d(0, battery::max_level);
+    std::vector<point_type> positions(node_num);
+    std::vector<double> seeds(node_num);
+    std::vector<int> levels(node_num);
+    for (size_t i = 0; i < node_num; ++i) {
+        for (size_t d = 0; d < dim; ++d) positions[i][d] = pos_d(gen);
+        seeds[i] = seed_d(gen);
+        levels[i] = level_d(gen);
+    }
+    parameters_t const& p = parameters();
+    battery::geometric model{p.increase_battery_prob, p.decrease_battery_prob};
+    soa::engine<dim> serial(positions, communication_range, seeds, levels, p.stale_factor, model, 2, 5, 1);
+    soa::engine<dim> parallel(positions, communication_range, seeds, levels, p.stale_factor, model, 2, 5, threads);
+    if (serial.edges() != parallel.edges()) {
+        std::cerr << "the adjacency has " << parallel.edges() << " edges instead of " << serial.edges() << std::endl;
+        return 1;
+    }
+
+    // links with a fixed probability, drawn from the pair and the round
+    auto link = [node_num](size_t r, size_t j, size_t i){
+        return node_random::uniform(j * node_num + i + 1, r) < 0.7;
+    };
+    size_t differences = 0;
+    for (size_t r = 1; r <= rounds; ++r) {
+        serial.round(link);
+        parallel.round(link);
+        for (size_t i = 0; i < node_num; ++i) {
+            std::array<real_t, 4> s = serial.node_counters(i), t = parallel.node_counters(i);
+            if (s == t) continue;
+            if (differences++ < 10) {
+                std::cerr << "round " << r << ", node " << i << ":";
+                for (size_t k = 0; k < s.size(); ++k) std::cerr << " " << s[k] << "/" << t[k];
+                std::cerr << std::endl;
+            }
+        }
+    }
+    std::cerr << differences << " of " << rounds * node_num << " node counters differ with " << threads << " threads" << std::endl;
+    return differences > 0;
+}